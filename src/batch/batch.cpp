@@ -0,0 +1,286 @@
+#include "batch.h"
+#include "common-whisper.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
+#include <spdlog/spdlog.h>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+Batch::Batch(const whisper_params &params)
+    : params(params), cparams(whisper_context_default_params()),
+      wparams(whisper_full_default_params(params.beam_size > 1
+                                              ? WHISPER_SAMPLING_BEAM_SEARCH
+                                              : WHISPER_SAMPLING_GREEDY)) {
+  cparams.use_gpu = params.use_gpu;
+  cparams.flash_attn = params.flash_attn;
+
+  ctx = whisper_init_from_file_with_params_no_state(this->params.model.c_str(),
+                                                    cparams);
+  if (ctx == nullptr) {
+    return;
+  }
+
+  // 语音段由不同的whisper_state乱序识别，不使用上一段的结果作为上下文
+  wparams.print_progress = false;
+  wparams.print_special = params.print_special;
+  wparams.print_realtime = false;
+  wparams.print_timestamps = false;
+  wparams.translate = params.translate;
+  wparams.language = this->params.language.c_str(); // 只是指针
+  wparams.no_context = true;
+  wparams.single_segment = false;
+  wparams.max_tokens = params.max_tokens;
+  wparams.beam_search.beam_size = params.beam_size;
+  wparams.audio_ctx = params.audio_ctx;
+  wparams.temperature_inc = params.no_fallback ? 0.0f : wparams.temperature_inc;
+  if (!whisper_is_multilingual(ctx) &&
+      (this->params.language != "en" || wparams.translate)) {
+    spdlog::warn("model is not multilingual, ignoring language and "
+                 "translation options");
+    this->params.language = "en";
+    wparams.language = this->params.language.c_str();
+    wparams.translate = false;
+  }
+
+  const int n_workers = std::max(params.stt_workers, 1);
+  wparams.n_threads = std::max(1, params.n_threads / n_workers);
+  // 默认每个识别线程有一个语音段在识别、一个在等待
+  window = params.in_flight > 0 ? params.in_flight : 2 * n_workers;
+
+  vad = std::make_unique<VadIterator>(params.vad_model, WHISPER_SAMPLE_RATE,
+                                      32, 0.5, MIN_SILENCE_MS, 30,
+                                      MIN_SPEECH_MS, MAX_SEGMENT_S);
+  pool = std::make_unique<WhisperPool>(
+      ctx, n_workers,
+      [this](whisper_state *state, span<const float> pcmf32, int) {
+        return transcribe(state, pcmf32);
+      },
+      [](string, int, Trace) {});
+  pool->start();
+  spdlog::info("batch: {} workers x {} threads, {} segments in flight",
+               n_workers, wparams.n_threads, window);
+}
+
+Batch::~Batch() {
+  if (pool) {
+    pool->stop();
+    pool.reset();
+  }
+  if (ctx != nullptr) {
+    whisper_free(ctx);
+  }
+}
+
+auto Batch::run(const std::vector<BatchInput> &files) -> Summary {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    summary = {};
+    summary.files = static_cast<int>(files.size());
+  }
+
+  // 输出路径 -> 先占用它的输入文件
+  std::map<fs::path, fs::path> outputs;
+  auto claim = [&](const BatchInput &input) {
+    for (const auto &format : params.formats) {
+      const auto path = output_path(input, format).lexically_normal();
+      const auto [it, inserted] = outputs.emplace(path, input.source);
+      if (!inserted) {
+        spdlog::error("batch: {} would overwrite {} of {}, skipped",
+                      input.source.string(), path.string(),
+                      it->second.string());
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const auto started = Clock::now();
+  for (const auto &input : files) {
+    if (!claim(input) || !submit(input)) {
+      std::lock_guard<std::mutex> lock(mutex);
+      summary.failed++;
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [this] { return unfinished == 0; });
+  summary.elapsed_seconds =
+      std::chrono::duration<double>(Clock::now() - started).count();
+  return summary;
+}
+
+auto Batch::submit(const BatchInput &input) -> bool {
+  const auto &path = input.source;
+  auto file = std::make_shared<File>();
+  file->started = Clock::now();
+  file->transcript.source = path;
+  file->name = input.name;
+
+  // 单声道，16kHz
+  vector<float> pcmf32;
+  vector<vector<float>> pcmf32s;
+  if (!read_audio_data(path.string(), pcmf32, pcmf32s, false)) {
+    spdlog::error("batch: cannot decode {}", path.string());
+    return false;
+  }
+  file->transcript.duration =
+      static_cast<double>(pcmf32.size()) / WHISPER_SAMPLE_RATE;
+
+  vad->process_batch(pcmf32, VAD_BATCH_LANES);
+  const auto &speeches = vad->get_speech_timestamps();
+  for (const auto &speech : speeches) {
+    file->transcript.cues.push_back(
+        {.start = static_cast<double>(speech.start) / WHISPER_SAMPLE_RATE,
+         .end = static_cast<double>(speech.end) / WHISPER_SAMPLE_RATE,
+         .text = {}});
+  }
+  file->remaining = speeches.size();
+  spdlog::info("batch: {} ({:.1f} s) split into {} segments", path.string(),
+               file->transcript.duration, speeches.size());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    summary.audio_seconds += file->transcript.duration;
+    summary.segments += static_cast<int>(speeches.size());
+    unfinished++;
+  }
+  if (speeches.empty()) {
+    finish(*file);
+    return true;
+  }
+
+  // 语音段共享整个文件的音频，最后一段完成后释放
+  const AudioChunk audio(std::move(pcmf32), WHISPER_SAMPLE_RATE);
+  for (size_t i = 0; i < speeches.size(); ++i) {
+    const auto start = static_cast<size_t>(speeches[i].start);
+    const auto end = std::min(static_cast<size_t>(speeches[i].end),
+                              audio.size());
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [this] { return in_flight < window; });
+      in_flight++;
+      summary.speech_seconds +=
+          static_cast<double>(end - start) / WHISPER_SAMPLE_RATE;
+    }
+
+    // 结果按提交顺序交付，同一文件的语音段依次完成
+    pool->submit(audio.slice(start, end - start), 0, 0,
+                 [this, file, i](string text, int, Trace) {
+                   file->transcript.cues[i].text = std::move(text);
+                   if (--file->remaining == 0) {
+                     finish(*file);
+                   }
+                   {
+                     std::lock_guard<std::mutex> lock(mutex);
+                     in_flight--;
+                   }
+                   cv.notify_all();
+                 });
+  }
+  return true;
+}
+
+void Batch::finish(const File &file) {
+  const auto &transcript = file.transcript;
+  bool written = true;
+  for (const auto &format : params.formats) {
+    const auto path = output_path({transcript.source, file.name}, format);
+    std::error_code error;
+    fs::create_directories(path.parent_path(), error);
+    if (!write_transcript(transcript, format, path)) {
+      spdlog::error("batch: cannot write {}", path.string());
+      written = false;
+    }
+  }
+
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - file.started).count();
+  spdlog::info("batch: {} done in {:.1f} s", transcript.source.string(),
+               elapsed);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!written) {
+      summary.failed++;
+    }
+    unfinished--;
+  }
+  cv.notify_all();
+}
+
+auto Batch::transcribe(whisper_state *state, std::span<const float> pcmf32)
+    -> std::string {
+  if (whisper_full_with_state(ctx, state, wparams, pcmf32.data(),
+                              static_cast<int>(pcmf32.size())) != 0) {
+    spdlog::error("batch: whisper failed on a {:.1f} s segment",
+                  static_cast<double>(pcmf32.size()) / WHISPER_SAMPLE_RATE);
+    return {};
+  }
+
+  std::string text;
+  const int n_segments = whisper_full_n_segments_from_state(state);
+  for (int i = 0; i < n_segments; ++i) {
+    text += whisper_full_get_segment_text_from_state(state, i);
+  }
+
+  // whisper的文本以空格开头
+  const auto begin = text.find_first_not_of(" \t\n");
+  if (begin == std::string::npos) {
+    return {};
+  }
+  const auto end = text.find_last_not_of(" \t\n");
+  return text.substr(begin, end - begin + 1);
+}
+
+auto Batch::output_path(const BatchInput &input,
+                        const std::string &format) const -> fs::path {
+  auto path = params.output_dir.empty()
+                  ? input.source
+                  : fs::path(params.output_dir) / input.name;
+  return path += "." + format;
+}
+
+auto batch_inputs(const std::vector<std::string> &inputs)
+    -> std::vector<BatchInput> {
+  static const std::set<std::string> extensions = {".wav", ".mp3", ".flac",
+                                                   ".ogg"};
+  auto is_audio = [](const fs::path &path) {
+    auto extension = path.extension().string();
+    std::ranges::transform(extension, extension.begin(), [](unsigned char c) {
+      return static_cast<char>(std::tolower(c));
+    });
+    return extensions.contains(extension);
+  };
+
+  std::vector<BatchInput> files;
+  for (const auto &input : inputs) {
+    std::error_code error;
+    if (fs::is_directory(input, error)) {
+      for (fs::recursive_directory_iterator it(input, error), end;
+           !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error) && is_audio(it->path())) {
+          files.push_back({it->path().lexically_normal(),
+                           it->path().lexically_relative(input)});
+        }
+      }
+      if (error) {
+        spdlog::warn("batch: cannot list {}: {}", input, error.message());
+      }
+    } else if (fs::is_regular_file(input, error)) {
+      files.push_back(
+          {fs::path(input).lexically_normal(), fs::path(input).filename()});
+    } else {
+      spdlog::warn("batch: {} not found, skipped", input);
+    }
+  }
+
+  // 同一个文件可能既被直接指定，又在指定的目录中
+  std::ranges::sort(files, {}, &BatchInput::source);
+  const auto duplicates = std::ranges::unique(files, {}, &BatchInput::source);
+  files.erase(duplicates.begin(), duplicates.end());
+  return files;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "parse.h"
+#include "silero-vad-onnx.h"
+#include "subtitle.h"
+#include "whisper-pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include <whisper.h>
+
+// 一个输入文件。name是输出文件名中格式扩展名之前的部分，保留原扩展名：在目录
+// 中找到的文件为相对该目录的路径(a/talk.wav)，直接指定的文件为文件名
+struct BatchInput {
+  std::filesystem::path source;
+  std::filesystem::path name;
+};
+
+// 离线批量识别音频文件(speakflow_batch)。文件逐个解码(read_audio_data，支持
+// WAV/MP3/FLAC/Vorbis)并用VAD切分为语音段，所有文件的语音段提交给同一个
+// WhisperPool，由多个whisper_state并行识别；下一个文件的解码和切分与前面文件
+// 的识别同时进行。已提交未完成的语音段不超过--in-flight个，已解码的音频因此
+// 有上限。一个文件的语音段全部完成后立即按--format写出字幕。
+class Batch {
+public:
+  struct Summary {
+    int files = 0;
+    int failed = 0; // 无法解码或写出的文件
+    int segments = 0;
+    double audio_seconds = 0.0;
+    double speech_seconds = 0.0; // 送去识别的语音段总时长
+    double elapsed_seconds = 0.0;
+
+    // 实时率：总耗时 / 音频总时长，小于1表示比实时快
+    [[nodiscard]] auto rtf() const -> double {
+      return audio_seconds > 0 ? elapsed_seconds / audio_seconds : 0.0;
+    }
+  };
+
+  explicit Batch(const whisper_params &params);
+  ~Batch();
+
+  Batch(const Batch &) = delete;
+  auto operator=(const Batch &) -> Batch & = delete;
+
+  // 模型加载失败时为false
+  [[nodiscard]] auto initialized() const -> bool { return ctx != nullptr; }
+  // 识别全部文件，所有字幕写出后返回。输出路径与前面的文件相同的文件
+  // 不识别，记为失败
+  auto run(const std::vector<BatchInput> &files) -> Summary;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct File {
+    Transcript transcript;
+    std::filesystem::path name;
+    size_t remaining = 0; // 尚未完成的语音段，只在交付线程中修改
+    Clock::time_point started;
+  };
+
+  // 解码并切分一个文件，语音段提交给pool，窗口已满时等待。无法解码时返回false
+  auto submit(const BatchInput &input) -> bool;
+  // 语音段全部完成后写出各格式的字幕
+  void finish(const File &file);
+  auto transcribe(whisper_state *state, std::span<const float> pcmf32)
+      -> std::string;
+  // 默认写在输入文件旁(talk.wav.srt)，指定--output-dir时在其中按name存放
+  [[nodiscard]] auto output_path(const BatchInput &input,
+                                 const std::string &format) const
+      -> std::filesystem::path;
+
+  whisper_params params;
+  whisper_context_params cparams;
+  whisper_full_params wparams;
+  whisper_context *ctx = nullptr;
+  std::unique_ptr<VadIterator> vad;
+  std::unique_ptr<WhisperPool> pool;
+  size_t window = 0; // 已提交未完成的语音段上限
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t in_flight = 0;
+  int unfinished = 0; // 已开始、尚未写出的文件
+  Summary summary;
+
+  static constexpr int MIN_SILENCE_MS = 500;     // 500ms静默切分语音段
+  static constexpr int MIN_SPEECH_MS = 250;      // 忽略小于250ms的语音段
+  static constexpr float MAX_SEGMENT_S = 15.0f;  // 一条字幕最长15秒
+  static constexpr int VAD_BATCH_LANES = 8;      // VAD批量推理的并行通道数
+};
+
+// 展开命令行中的文件和目录(递归查找音频文件)，按路径排序
+auto batch_inputs(const std::vector<std::string> &inputs)
+    -> std::vector<BatchInput>;
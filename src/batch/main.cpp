@@ -0,0 +1,56 @@
+// 离线批量识别音频文件，每个文件写出字幕，最后输出总的实时率。
+//
+//   speakflow_batch --input talks/ --format srt --format json --stt-workers 4
+//   speakflow_batch --input a.mp3 --input b.flac --output-dir subs -l zh
+//
+// 日志写到标准错误，标准输出只有最后一行统计。
+#include "batch.h"
+
+#include <filesystem>
+#include <print>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <system_error>
+
+auto main(int argc, char **argv) -> int {
+  whisper_params params;
+  if (!whisper_params_parse(argc, argv, params)) {
+    return 1;
+  }
+  spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+
+  if (params.language != "auto" &&
+      whisper_lang_id(params.language.c_str()) == -1) {
+    spdlog::error("unknown language '{}'", params.language);
+    return 1;
+  }
+
+  const auto files = batch_inputs(params.inputs);
+  if (files.empty()) {
+    spdlog::error("no audio files given, use --input FILE_OR_DIR");
+    return 1;
+  }
+  if (!params.output_dir.empty()) {
+    std::error_code error;
+    std::filesystem::create_directories(params.output_dir, error);
+    if (error) {
+      spdlog::error("cannot create {}: {}", params.output_dir,
+                    error.message());
+      return 1;
+    }
+  }
+
+  Batch batch(params);
+  if (!batch.initialized()) {
+    spdlog::error("cannot load model {}", params.model);
+    return 1;
+  }
+
+  const auto summary = batch.run(files);
+  std::println("{} files ({} failed), {} segments, {:.1f} s audio ({:.1f} s "
+               "speech) in {:.1f} s, RTF {:.3f}",
+               summary.files, summary.failed, summary.segments,
+               summary.audio_seconds, summary.speech_seconds,
+               summary.elapsed_seconds, summary.rtf());
+  return summary.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include "subtitle.h"
+#include "common-whisper.h"
+
+#include <cmath>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// to_timestamp以10ms为单位
+auto timestamp(double seconds, bool comma) -> std::string {
+  return to_timestamp(std::llround(seconds * 100.0), comma);
+}
+
+void write_srt(const Transcript &transcript, std::ostream &out) {
+  int index = 0;
+  for (const auto &cue : transcript.cues) {
+    if (cue.text.empty()) {
+      continue;
+    }
+    out << ++index << '\n'
+        << timestamp(cue.start, true) << " --> " << timestamp(cue.end, true)
+        << '\n'
+        << cue.text << "\n\n";
+  }
+}
+
+void write_vtt(const Transcript &transcript, std::ostream &out) {
+  out << "WEBVTT\n\n";
+  for (const auto &cue : transcript.cues) {
+    if (cue.text.empty()) {
+      continue;
+    }
+    out << timestamp(cue.start, false) << " --> "
+        << timestamp(cue.end, false) << '\n'
+        << cue.text << "\n\n";
+  }
+}
+
+void write_json(const Transcript &transcript, std::ostream &out) {
+  auto segments = nlohmann::json::array();
+  for (const auto &cue : transcript.cues) {
+    if (!cue.text.empty()) {
+      segments.push_back(
+          {{"start", cue.start}, {"end", cue.end}, {"text", cue.text}});
+    }
+  }
+  const nlohmann::json document = {{"file", transcript.source.string()},
+                                   {"duration", transcript.duration},
+                                   {"segments", std::move(segments)}};
+  out << document.dump(2, ' ', false,
+                       nlohmann::json::error_handler_t::replace)
+      << '\n';
+}
+
+} // namespace
+
+auto write_transcript(const Transcript &transcript, const std::string &format,
+                      const std::filesystem::path &path) -> bool {
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    return false;
+  }
+  if (format == "srt") {
+    write_srt(transcript, out);
+  } else if (format == "vtt") {
+    write_vtt(transcript, out);
+  } else if (format == "json") {
+    write_json(transcript, out);
+  } else {
+    return false;
+  }
+  return static_cast<bool>(out.flush());
+}
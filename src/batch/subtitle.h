@@ -0,0 +1,23 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// 一个语音段的识别结果，时间从文件开头算起，单位为秒
+struct Cue {
+  double start = 0.0;
+  double end = 0.0;
+  std::string text;
+};
+
+// 一个文件的识别结果
+struct Transcript {
+  std::filesystem::path source;
+  double duration = 0.0; // 音频时长(秒)
+  std::vector<Cue> cues; // 按时间顺序
+};
+
+// 按format(srt、vtt或json)写出，文本为空的语音段不写。失败时返回false
+auto write_transcript(const Transcript &transcript, const std::string &format,
+                      const std::filesystem::path &path) -> bool;
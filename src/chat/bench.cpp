@@ -0,0 +1,184 @@
+#include "chat.h"
+#include "events.h"
+#include "histogram.h"
+#include "mock-server.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+
+// Drives Chat against the in-tree mock LLM the way STT does, by publishing
+// MessageAddedEvent("stt", ...), with and without streaming. Reports the
+// HTTP request latency, how long messages waited in Chat's queue, the
+// latency from a message to its reply (and to the first token when
+// streaming), and the throughput.
+//
+//   chat_bench [messages] [ms between messages] [ms per token] [tokens]
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  int n_messages = 50;
+  std::chrono::milliseconds interval{20};
+  std::chrono::milliseconds token_delay{5};
+  int n_tokens = 16;
+};
+
+// Chat sends every queued message in one request. A "## USER" message
+// marks the start of a request, covering everything published before it.
+class Recorder {
+public:
+  void published() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(Clock::now());
+  }
+
+  void request_started() {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto now = Clock::now();
+    batch = std::move(pending);
+    pending.clear();
+    for (auto t : batch) {
+      queue_wait.record(now - t);
+    }
+    first_token = true;
+  }
+
+  void token() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (first_token) {
+      for (auto t : batch) {
+        to_first_token.record(Clock::now() - t);
+      }
+      first_token = false;
+    }
+  }
+
+  void reply() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto now = Clock::now();
+      for (auto t : batch) {
+        to_reply.record(now - t);
+      }
+      replied += batch.size();
+      batch.clear();
+      last_reply = now;
+    }
+    cv.notify_all();
+  }
+
+  auto wait(size_t n_messages, std::chrono::seconds timeout) -> bool {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, timeout,
+                       [&]() { return replied >= n_messages; });
+  }
+
+  LatencyHistogram queue_wait;
+  LatencyHistogram to_first_token;
+  LatencyHistogram to_reply;
+  Clock::time_point last_reply;
+
+private:
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Clock::time_point> pending;
+  std::deque<Clock::time_point> batch;
+  size_t replied = 0;
+  bool first_token = false;
+};
+
+void print(const std::string &name, const LatencyHistogram &histogram) {
+  auto ms = [](LatencyHistogram::Seconds s) { return s.count() * 1e3; };
+  std::cout << "  " << name << ": p50 " << ms(histogram.percentile(0.5))
+            << " ms, p99 " << ms(histogram.percentile(0.99)) << " ms, max "
+            << ms(histogram.max()) << " ms (" << histogram.count() << ")\n";
+}
+
+void run(const Options &options, bool stream) {
+  MockLlmServer server({0, std::chrono::milliseconds(0), options.token_delay,
+                        options.n_tokens});
+  auto eventBus = std::make_shared<EventBus>();
+  Recorder recorder;
+
+  eventBus->subscribe<MessageAddedEvent>(
+      [&recorder](const MessageAddedEvent &messageEvent) {
+        if (messageEvent.serviceName != "chat") {
+          return;
+        }
+        if (messageEvent.message.starts_with("## USER")) {
+          recorder.request_started();
+        } else if (messageEvent.message.starts_with("## AI")) {
+          recorder.reply();
+        }
+      });
+  eventBus->subscribe<MessageDeltaEvent>(
+      [&recorder](const MessageDeltaEvent &deltaEvent) {
+        if (deltaEvent.done) {
+          recorder.reply();
+        } else if (!deltaEvent.delta.starts_with("## AI")) {
+          recorder.token();
+        }
+      });
+
+  Chat chat(server.url(), "", "mock", 10000, "", eventBus, stream);
+  eventBus->publish<StartServiceEvent>("chat");
+
+  const auto t0 = Clock::now();
+  for (int i = 0; i < options.n_messages; ++i) {
+    recorder.published();
+    eventBus->publish<MessageAddedEvent>("stt",
+                                         "message " + std::to_string(i));
+    std::this_thread::sleep_for(options.interval);
+  }
+  const bool finished = recorder.wait(options.n_messages,
+                                      std::chrono::seconds(60));
+  const std::chrono::duration<double> elapsed = recorder.last_reply - t0;
+  eventBus->publish<StopServiceEvent>("chat");
+
+  std::cout << (stream ? "streaming" : "non-streaming") << ", "
+            << options.n_messages << " messages every "
+            << options.interval.count() << " ms, " << options.n_tokens
+            << " tokens at " << options.token_delay.count() << " ms:\n";
+  if (!finished) {
+    std::cout << "  timed out\n";
+  }
+  print("request", chat.latency("chat"));
+  print("queue wait", recorder.queue_wait);
+  if (stream) {
+    print("to first token", recorder.to_first_token);
+  }
+  print("to reply", recorder.to_reply);
+  std::cout << "  " << options.n_messages / elapsed.count()
+            << " messages/s, " << chat.latency("chat").count()
+            << " requests on " << server.connections() << " connections\n";
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  Options options;
+  if (argc > 1) {
+    options.n_messages = std::stoi(argv[1]);
+  }
+  if (argc > 2) {
+    options.interval = std::chrono::milliseconds(std::stoi(argv[2]));
+  }
+  if (argc > 3) {
+    options.token_delay = std::chrono::milliseconds(std::stoi(argv[3]));
+  }
+  if (argc > 4) {
+    options.n_tokens = std::stoi(argv[4]);
+  }
+  spdlog::set_level(spdlog::level::warn);
+
+  run(options, false);
+  run(options, true);
+  return 0;
+}
@@ -0,0 +1,112 @@
+#include "chat-context.h"
+
+#include <utility>
+
+namespace {
+
+const string SUMMARY_HEADER = "\n\nSummary of the earlier conversation:\n";
+
+auto is_word(unsigned char c) -> bool {
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') ||
+         (c >= 'a' && c <= 'z');
+}
+
+} // namespace
+
+ChatContext::ChatContext(string system, size_t budget_tokens,
+                         Strategy strategy)
+    : m_system(std::move(system)), budget(budget_tokens),
+      m_strategy(strategy) {
+  system_tokens = m_system.empty()
+                      ? 0
+                      : approx_tokens(m_system) + MESSAGE_OVERHEAD;
+}
+
+void ChatContext::add(string role, string content) {
+  const size_t tokens = approx_tokens(content) + MESSAGE_OVERHEAD;
+  history_tokens += tokens;
+  history.push_back({std::move(role), std::move(content), tokens});
+}
+
+void ChatContext::pop() {
+  if (!history.empty()) {
+    history_tokens -= history.back().tokens;
+    history.pop_back();
+  }
+}
+
+// Turns are evicted whole: a user message goes together with the assistant
+// reply that follows it, so the history never starts with a reply.
+auto ChatContext::fit() -> vector<Message> {
+  vector<Message> evicted;
+  if (budget == 0) {
+    return evicted;
+  }
+  while (total_tokens() > budget && history.size() > 1) {
+    do {
+      history_tokens -= history.front().tokens;
+      if (m_strategy == Strategy::Summary) {
+        evicted.push_back(std::move(history.front()));
+      }
+      history.pop_front();
+    } while (history.size() > 1 && history.front().role != "user");
+  }
+  return evicted;
+}
+
+void ChatContext::setSummary(string text) {
+  m_summary = std::move(text);
+  system_tokens = approx_tokens(system()) + MESSAGE_OVERHEAD;
+}
+
+auto ChatContext::system() const -> string {
+  if (m_summary.empty()) {
+    return m_system;
+  }
+  return m_system + SUMMARY_HEADER + m_summary;
+}
+
+auto ChatContext::usage() const -> Usage {
+  Usage usage{history.size(), total_tokens(), 0};
+  if (system_tokens > 0) {
+    usage.messages++;
+    usage.bytes += m_system.size();
+    if (!m_summary.empty()) {
+      usage.bytes += SUMMARY_HEADER.size() + m_summary.size();
+    }
+  }
+  for (const auto &message : history) {
+    usage.bytes += message.content.size();
+  }
+  return usage;
+}
+
+auto ChatContext::total_tokens() const -> size_t {
+  return system_tokens + history_tokens;
+}
+
+auto ChatContext::approx_tokens(string_view text) -> size_t {
+  size_t tokens = 0;
+  size_t word = 0; // length of the current run of letters and digits
+  for (size_t i = 0; i < text.size();) {
+    const auto c = static_cast<unsigned char>(text[i]);
+    if (is_word(c)) {
+      ++word;
+      ++i;
+      continue;
+    }
+    tokens += (word + 3) / 4;
+    word = 0;
+
+    if (c < 0x80) {
+      // spaces merge into the next word, punctuation is a token of its own
+      tokens += c == ' ' || c == '\n' || c == '\t' ? 0 : 1;
+      ++i;
+    } else {
+      // one token per multi-byte character, mostly CJK here
+      ++tokens;
+      i += c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+    }
+  }
+  return tokens + (word + 3) / 4;
+}
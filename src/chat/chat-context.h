@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Conversation history sent with every request, kept within a token budget
+// so that request size and LLM latency stay flat over long sessions.
+// Tokens are estimated locally, without the model's tokenizer.
+class ChatContext {
+public:
+  enum class Strategy {
+    Window,  // drop the oldest turns
+    Summary, // replace the oldest turns by a summary of them
+  };
+
+  struct Message {
+    string role; // "user" or "assistant"
+    string content;
+    size_t tokens;
+  };
+
+  // What one request sends: the system prompt and every message.
+  struct Usage {
+    size_t messages = 0;
+    size_t tokens = 0;
+    size_t bytes = 0;
+  };
+
+  // A budget of 0 keeps the whole history.
+  ChatContext(string system, size_t budget_tokens,
+              Strategy strategy = Strategy::Window);
+
+  void add(string role, string content);
+  // Undoes add() of a request that failed.
+  void pop();
+
+  // Evicts the oldest turns until the context fits the budget, keeping at
+  // least the newest message. With Strategy::Summary the evicted messages
+  // are returned so that they can be summarized into setSummary().
+  auto fit() -> vector<Message>;
+  void setSummary(string text);
+
+  // The system prompt, followed by the summary of evicted turns if any.
+  [[nodiscard]] auto system() const -> string;
+  [[nodiscard]] auto messages() const -> const deque<Message> & {
+    return history;
+  }
+  [[nodiscard]] auto usage() const -> Usage;
+  [[nodiscard]] auto strategy() const -> Strategy { return m_strategy; }
+  [[nodiscard]] auto summary() const -> const string & { return m_summary; }
+
+  // Roughly 4 characters per token for Latin text and one token per CJK
+  // character, which is within ~20% of the BPE tokenizers in common use.
+  static auto approx_tokens(string_view text) -> size_t;
+  // Role and separators added by the chat template around every message.
+  static constexpr size_t MESSAGE_OVERHEAD = 4;
+
+private:
+  auto total_tokens() const -> size_t;
+
+  string m_system;
+  string m_summary;
+  size_t system_tokens = 0; // system() including the summary
+  size_t budget;
+  Strategy m_strategy;
+  deque<Message> history;
+  size_t history_tokens = 0;
+};
@@ -1,56 +1,44 @@
 #include "chat.h"
 #include "events.h"
-#include "liboai.h"
+#include "sse.h"
+#include <nlohmann/json.hpp>
 #include <print>
 #include <spdlog/spdlog.h>
 #include <thread>
 #include <utility>
 
 Chat::Chat(string url, string key, string model, int32_t timeout, string system,
-           std::shared_ptr<EventBus> bus)
-    : stopChat(false), key(key), model(std::move(model)), url(url),
-      timeout(timeout), system(system), eventBus(std::move(bus)) {
-
-  oai = new OpenAI(url);
-
-  if (!oai->auth.SetKey(key)) {
-    spdlog::error("auth failed!");
-  }
-
-  oai->auth.SetMaxTimeout(timeout);
-
-  if (system != "") {
-    if (!convo.SetSystemData(system)) {
-      spdlog::error("set system data failed");
-    }
-  }
+           std::shared_ptr<EventBus> bus, bool stream, size_t context_tokens,
+           ChatContext::Strategy strategy, size_t n_connections)
+    : eventBus(std::move(bus)), stopChat(false),
+      http(url, key, timeout, n_connections),
+      context(system, context_tokens, strategy), key(key), url(url),
+      model(std::move(model)), timeout(timeout), system(system),
+      stream(stream) {
 
   eventBus->subscribe<StartServiceEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto startEvent = std::static_pointer_cast<StartServiceEvent>(event);
-        if (startEvent->serviceName == "chat") {
+      [this](const StartServiceEvent &startEvent) {
+        if (startEvent.serviceName == "chat") {
           start();
           eventBus->publish<ServiceStatusEvent>("chat", true);
         }
       });
 
   eventBus->subscribe<StopServiceEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto stopEvent = std::static_pointer_cast<StopServiceEvent>(event);
-        if (stopEvent->serviceName == "chat") {
+      [this](const StopServiceEvent &stopEvent) {
+        if (stopEvent.serviceName == "chat") {
           stop();
           eventBus->publish<ServiceStatusEvent>("chat", false);
         }
       });
 
   eventBus->subscribe<MessageAddedEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto messageEvent = std::static_pointer_cast<MessageAddedEvent>(event);
-        if (messageEvent->serviceName == "stt") {
+      [this](const MessageAddedEvent &messageEvent) {
+        if (messageEvent.serviceName == "stt") {
           string keyword = "明镜与点点";
-          if (messageEvent->message != "" &&
-              messageEvent->message.find(keyword) == string::npos) {
-            addMessage(messageEvent->message);
+          if (messageEvent.message != "" &&
+              messageEvent.message.find(keyword) == string::npos) {
+            addMessage(messageEvent.message, messageEvent.trace);
           }
         }
       });
@@ -65,19 +53,49 @@ void Chat::stop() {
   }
   cv.notify_all();
   chatThread.join();
+  if (pendingSummary.valid()) {
+    pendingSummary.wait();
+  }
+
+  for (const auto &kind : http.labels()) {
+    const auto histogram = http.latency(kind);
+    spdlog::info("Chat: {} {} requests, p50 {:.0f} ms, p99 {:.0f} ms, max "
+                 "{:.0f} ms",
+                 histogram.count(), kind,
+                 histogram.percentile(0.5).count() * 1e3,
+                 histogram.percentile(0.99).count() * 1e3,
+                 histogram.max().count() * 1e3);
+  }
 }
 
-void Chat::addMessage(const string &messageText) {
+void Chat::addMessage(const string &messageText, Trace trace) {
   {
     lock_guard<mutex> lock(queueMutex);
-    messageQueue.push({messageText});
+    messageQueue.push({messageText, trace, Tracer::Clock::now()});
+    queueMetric.set(static_cast<double>(messageQueue.size()));
   }
   cv.notify_one();
 }
 
+namespace {
+
+// One span per sentence answered, from start until now
+void trace_all(const char *name, const vector<Trace> &traces,
+               Tracer::Clock::time_point start) {
+  for (const auto &trace : traces) {
+    Tracer::instance().record(name, trace, start);
+  }
+}
+
+} // namespace
+
 void Chat::processMessages() {
+  // connect before the first message instead of on it
+  http.warm_up();
+
   while (true) {
     string message = "";
+    vector<Trace> traces;
 
     {
       unique_lock<mutex> lock(queueMutex);
@@ -87,10 +105,19 @@ void Chat::processMessages() {
         return;
       }
 
+      const auto taken = Tracer::Clock::now();
       while (!messageQueue.empty()) {
-        message += messageQueue.front();
+        auto &pending = messageQueue.front();
+        message += pending.text;
+        Tracer::instance().record("chat.queue", pending.trace.id,
+                                  pending.queued, taken);
+        if (pending.trace.id != 0) {
+          traces.push_back(pending.trace);
+        }
         messageQueue.pop();
       }
+      queueMetric.set(0);
+      busy = true;
 
       eventBus->publish<MessageClearedEvent>();
     }
@@ -98,44 +125,224 @@ void Chat::processMessages() {
     spdlog::info("Processing message: {0}", message);
     message_count += 1;
 
+    const Trace trace = traces.empty() ? Trace{} : traces.front();
     eventBus->publish<MessageAddedEvent>(
-        "chat", format("## USER {} \n", message_count) + message);
+        "chat", format("## USER {} \n", message_count) + message, 0, trace);
 
-    string response = wait_response(message);
-    // callback
+    const auto requested = Tracer::Clock::now();
+    if (stream) {
+      // the reply is shown while it is generated
+      eventBus->publish<MessageDeltaEvent>(
+          "chat", format("## AI {} \n", message_count));
+      stream_response(message, traces);
+      replyMetric.record(Tracer::Clock::now() - requested);
+      trace_all("chat.request", traces, requested);
+      eventBus->publish<MessageDeltaEvent>("chat", "", true);
+    } else {
+      string response = wait_response(message);
+      replyMetric.record(Tracer::Clock::now() - requested);
+      trace_all("chat.request", traces, requested);
+      // callback
 
-    eventBus->publish<MessageAddedEvent>(
-        "chat", format("## AI {} \n", message_count) + response);
+      eventBus->publish<MessageAddedEvent>(
+          "chat", format("## AI {} \n", message_count) + response, 0, trace);
+    }
+
+    // from the capture of each sentence to its reply
+    for (const auto &sentence : traces) {
+      if (sentence.captured != Tracer::Clock::time_point{}) {
+        Tracer::instance().record("e2e", sentence, sentence.captured);
+      }
+    }
+
+    lock_guard<mutex> lock(queueMutex);
+    busy = false;
+  }
+}
+
+auto Chat::idle() -> bool {
+  lock_guard<mutex> lock(queueMutex);
+  return messageQueue.empty() && !busy;
+}
+
+namespace {
+
+const string COMPLETIONS = "/chat/completions";
+
+// choices[0].message.content of a chat.completion
+auto completion_content(string_view body) -> optional<string> {
+  const auto completion = nlohmann::json::parse(body, nullptr, false);
+  if (completion.is_discarded() || !completion.contains("choices") ||
+      completion["choices"].empty()) {
+    return nullopt;
+  }
+  const auto &message =
+      completion["choices"][0].value("message", nlohmann::json{});
+  if (!message.contains("content") || !message["content"].is_string()) {
+    return nullopt;
+  }
+  return message["content"].get<string>();
+}
+
+auto request_body(const string &model, const string &system,
+                  const deque<ChatContext::Message> &history, bool stream)
+    -> string {
+  auto messages = nlohmann::json::array();
+  if (!system.empty()) {
+    messages.push_back({{"role", "system"}, {"content", system}});
+  }
+  for (const auto &message : history) {
+    messages.push_back({{"role", message.role}, {"content", message.content}});
+  }
+  const nlohmann::json body = {
+      {"model", model}, {"messages", messages}, {"stream", stream}};
+  // transcripts may end in a broken UTF-8 sequence
+  return body.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+void log_failure(const HttpPool::Response &response) {
+  if (!response.error.empty()) {
+    spdlog::error("Chat: request failed: {}", response.error);
+  } else {
+    spdlog::error("Chat: HTTP {}: {}", response.status, response.body);
   }
 }
 
+} // namespace
+
 auto Chat::wait_response(const string input) -> string {
   // add a message to the conversation
-  if (!convo.AddUserData(input)) {
-    return "This is a error: add a message failed";
+  const string body = prepare(input, false);
+
+  const auto response = http.post("chat", COMPLETIONS, body);
+  if (!response.ok()) {
+    log_failure(response);
+    context.pop();
+    return "This is a error: try fail";
   }
 
-  try {
-    auto fut = oai->ChatCompletion->create_async(model, convo);
+  auto reply = completion_content(response.body);
+  if (!reply) {
+    spdlog::error("Chat: unexpected response: {}", response.body);
+    context.pop();
+    return "This is a error: update conversation failed";
+  }
 
-    // check if the future is ready
-    fut.wait();
+  // print the response
+  spdlog::info("AI responce is: {0}", *reply);
 
-    // get the contained response
-    auto response = fut.get();
+  context.add("assistant", *reply);
+  return *reply;
+}
+
+// Deltas are published as the chunks arrive, so the first words show up
+// after the time to first token rather than after the whole reply.
+auto Chat::stream_response(const string input, const vector<Trace> &traces)
+    -> string {
+  const string body = prepare(input, true);
+
+  string reply;
+  const auto requested = Tracer::Clock::now();
+  bool first = true;
+  SseParser parser([&, requested](string_view data) {
+    if (auto delta = chat_delta(data)) {
+      if (first) {
+        firstTokenMetric.record(Tracer::Clock::now() - requested);
+        trace_all("chat.first_token", traces, requested);
+        first = false;
+      }
+      reply += *delta;
+      eventBus->publish<MessageDeltaEvent>("chat", std::move(*delta));
+    }
+  });
 
-    // update our conversation with the response
-    if (!convo.Update(response)) {
-      spdlog::error("update conversation failed");
-      return "This is a error: update conversation failed";
+  // an error body is not an event stream, keep it for the log
+  string raw;
+  auto response = http.post("chat", COMPLETIONS, body, [&](string_view chunk) {
+    if (raw.size() < 4096) {
+      raw.append(chunk.substr(0, 4096 - raw.size()));
     }
+    parser.feed(chunk);
+    return true;
+  });
+  parser.finish();
 
-    // print the response
-    spdlog::info("AI responce is: {0}", convo.GetLastResponse());
+  if (!response.ok()) {
+    response.body = std::move(raw);
+    log_failure(response);
+    context.pop();
+    string error = "This is a error: try fail";
+    eventBus->publish<MessageDeltaEvent>("chat", error);
+    return error;
+  }
 
-    return convo.GetLastResponse();
-  } catch (std::exception &e) {
-    spdlog::error(e.what());
-    return "This is a error: try fail";
+  spdlog::info("AI responce is: {0}", reply);
+  spdlog::info("Chat: first byte after {:.0f} ms on a {} connection",
+               response.first_byte * 1e3, response.reused ? "reused" : "new");
+  context.add("assistant", reply);
+  return reply;
+}
+
+// Only the turns within the budget are sent.
+auto Chat::prepare(const string &input, bool stream) -> string {
+  collect_summary();
+
+  context.add("user", input);
+  auto evicted = context.fit();
+  if (!evicted.empty()) {
+    summarize(evicted);
+  }
+
+  const auto usage = context.usage();
+  spdlog::info("Chat: request with {} messages, ~{} tokens, {} bytes",
+               usage.messages, usage.tokens, usage.bytes);
+  return request_body(model, context.system(), context.messages(), stream);
+}
+
+// Folds the evicted turns and the previous summary into a new summary. If
+// the request fails the turns are simply dropped, as with the window.
+void Chat::summarize(const vector<ChatContext::Message> &evicted) {
+  collect_summary();
+
+  string transcript;
+  if (!context.summary().empty()) {
+    transcript = "Earlier summary: " + context.summary() + "\n";
+  }
+  for (const auto &message : evicted) {
+    transcript += message.role + ": " + message.content + "\n";
+  }
+
+  const deque<ChatContext::Message> request = {
+      {"user", std::move(transcript), 0}};
+  string body = request_body(
+      model,
+      "Summarize the conversation below in a few sentences, in its own "
+      "language. Keep names, facts, decisions and open questions. Reply "
+      "with the summary only.",
+      request, false);
+
+  pendingSummary = async(
+      launch::async,
+      [this, body = std::move(body),
+       n_evicted = evicted.size()]() -> optional<string> {
+        const auto response = http.post("summary", COMPLETIONS, body);
+        if (!response.ok()) {
+          log_failure(response);
+          return nullopt;
+        }
+        auto summary = completion_content(response.body);
+        if (summary) {
+          spdlog::info("Chat: summarized {} messages", n_evicted);
+        }
+        return summary;
+      });
+}
+
+void Chat::collect_summary() {
+  if (!pendingSummary.valid()) {
+    return;
+  }
+  if (auto summary = pendingSummary.get()) {
+    context.setSummary(std::move(*summary));
   }
 }
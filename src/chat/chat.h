@@ -1,41 +1,88 @@
 #pragma once
 
-#include "liboai.h"
-
+#include "chat-context.h"
 #include "eventbus.h"
+#include "http-pool.h"
+#include "metrics.h"
+#include "trace.h"
 #include <condition_variable>
+#include <future>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
-using namespace liboai;
 using namespace std;
 
 class Chat {
 public:
+  // With stream set, replies are requested as server-sent events and
+  // published piece by piece as MessageDeltaEvent. The history sent with
+  // each request is kept within context_tokens (0: unlimited).
   Chat(string url, string key, string model, int32_t timeout, string system,
-       std::shared_ptr<EventBus> bus);
+       std::shared_ptr<EventBus> bus, bool stream = false,
+       size_t context_tokens = 0,
+       ChatContext::Strategy strategy = ChatContext::Strategy::Window,
+       size_t n_connections = 2);
+
+  // Latency of the requests sent so far by kind: "chat", "summary" or
+  // "warmup".
+  [[nodiscard]] auto latency(string_view kind) const -> LatencyHistogram {
+    return http.latency(kind);
+  }
+
+  // No message is queued and no reply is being generated.
+  [[nodiscard]] auto idle() -> bool;
 
 private:
-  void addMessage(const string &messageText);
+  // A transcript waiting for the next request, traced back to its sentence
+  struct Pending {
+    string text;
+    Trace trace;
+    Tracer::Clock::time_point queued;
+  };
+
+  void addMessage(const string &messageText, Trace trace = {});
 
   void start();
   void stop();
 
   void processMessages();
   auto wait_response(const string input) -> string;
+  // traces: the sentences answered, for the time to first token
+  auto stream_response(const string input, const vector<Trace> &traces)
+      -> string;
+
+  // Adds input to the context, fits it into the budget and returns the
+  // request body.
+  auto prepare(const string &input, bool stream) -> string;
+  // Summarizes evicted turns on a second connection while the reply is
+  // generated; the summary is taken by the next prepare().
+  void summarize(const vector<ChatContext::Message> &evicted);
+  void collect_summary();
 
   std::shared_ptr<EventBus> eventBus;
 
-  queue<string> messageQueue; // Message queue
-  mutex queueMutex;           // Mutex to protect the message queue
-  condition_variable cv;      // Condition variable for thread synchronization
-  bool stopChat;              // Whether to stop the chat system
-  thread chatThread;          // Chat system thread
+  queue<Pending> messageQueue; // Message queue
+  mutex queueMutex;            // Mutex to protect the message queue
+  condition_variable cv;       // Condition variable for thread synchronization
+  bool stopChat;               // Whether to stop the chat system
+  bool busy = false;           // A request is in progress
+  thread chatThread;           // Chat system thread
+
+  // Messages waiting for a request, and the time from sending a request to
+  // the first token and to the whole reply
+  Gauge &queueMetric = Metrics::instance().gauge("chat.queue");
+  Histogram &firstTokenMetric =
+      Metrics::instance().histogram("chat.first_token");
+  Histogram &replyMetric = Metrics::instance().histogram("chat.reply");
 
-  OpenAI *oai;
-  Conversation convo;
+  HttpPool http; // keep-alive connections to url
+  ChatContext context;
+  future<optional<string>> pendingSummary;
   string key;
   string url;
   int message_count = 0;
@@ -45,4 +92,6 @@ private:
   int32_t timeout;
 
   string system;
+
+  bool stream = false;
 };
@@ -0,0 +1,167 @@
+#include "http-pool.h"
+
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <utility>
+
+namespace {
+
+struct Transfer {
+  const HttpPool::OnData *on_data;
+  string *body;
+};
+
+auto write_body(char *data, size_t size, size_t n, void *user) -> size_t {
+  auto *transfer = static_cast<Transfer *>(user);
+  const size_t bytes = size * n;
+  if (*transfer->on_data) {
+    // a short count makes libcurl abort the transfer
+    return (*transfer->on_data)(string_view(data, bytes)) ? bytes : 0;
+  }
+  transfer->body->append(data, bytes);
+  return bytes;
+}
+
+} // namespace
+
+HttpPool::HttpPool(string base_url, string key, long timeout_ms,
+                   size_t n_connections)
+    : base_url(std::move(base_url)), timeout_ms(timeout_ms) {
+  static const CURLcode global = curl_global_init(CURL_GLOBAL_DEFAULT);
+  if (global != CURLE_OK) {
+    spdlog::error("HttpPool: curl_global_init failed: {}",
+                  curl_easy_strerror(global));
+  }
+
+  while (!this->base_url.empty() && this->base_url.back() == '/') {
+    this->base_url.pop_back();
+  }
+  headers = curl_slist_append(headers, "Content-Type: application/json");
+  if (!key.empty()) {
+    headers =
+        curl_slist_append(headers, ("Authorization: Bearer " + key).c_str());
+  }
+
+  for (size_t i = 0; i < max<size_t>(n_connections, 1); ++i) {
+    CURL *handle = curl_easy_init();
+    if (handle == nullptr) {
+      spdlog::error("HttpPool: failed to create connection {}", i);
+      break;
+    }
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, write_body);
+    handles.push_back(handle);
+  }
+  idle = handles;
+}
+
+HttpPool::~HttpPool() {
+  for (auto *handle : handles) {
+    curl_easy_cleanup(handle);
+  }
+  curl_slist_free_all(headers);
+}
+
+auto HttpPool::post(string_view label, string_view path, const string &body,
+                    const OnData &on_data) -> Response {
+  return perform(label, path, &body, on_data);
+}
+
+auto HttpPool::get(string_view label, string_view path) -> Response {
+  return perform(label, path, nullptr, nullptr);
+}
+
+void HttpPool::warm_up(string_view path) {
+  vector<thread> threads;
+  for (size_t i = 0; i < handles.size(); ++i) {
+    threads.emplace_back([this, path]() {
+      const auto response = get("warmup", path);
+      if (!response.error.empty()) {
+        spdlog::warn("HttpPool: warm-up failed: {}", response.error);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+auto HttpPool::latency(string_view label) const -> LatencyHistogram {
+  lock_guard<mutex> lock(poolMutex);
+  auto it = histograms.find(label);
+  return it == histograms.end() ? LatencyHistogram{} : it->second;
+}
+
+auto HttpPool::labels() const -> vector<string> {
+  lock_guard<mutex> lock(poolMutex);
+  vector<string> result;
+  for (const auto &[label, histogram] : histograms) {
+    result.push_back(label);
+  }
+  return result;
+}
+
+auto HttpPool::perform(string_view label, string_view path, const string *body,
+                       const OnData &on_data) -> Response {
+  Response response;
+  CURL *handle = acquire();
+  if (handle == nullptr) {
+    response.error = "no connection";
+    return response;
+  }
+
+  const string url = base_url + string(path);
+  Transfer transfer{&on_data, &response.body};
+  curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer);
+  if (body != nullptr) {
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body->data());
+    curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE,
+                     static_cast<curl_off_t>(body->size()));
+  } else {
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+  }
+
+  const CURLcode code = curl_easy_perform(handle);
+  if (code != CURLE_OK) {
+    response.error = curl_easy_strerror(code);
+  }
+  long n_connects = 0;
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response.status);
+  curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &response.seconds);
+  curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME, &response.first_byte);
+  curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &n_connects);
+  response.reused = n_connects == 0;
+  release(handle);
+
+  lock_guard<mutex> lock(poolMutex);
+  auto it = histograms.find(label);
+  if (it == histograms.end()) {
+    it = histograms.emplace(string(label), LatencyHistogram{}).first;
+  }
+  it->second.record(LatencyHistogram::Seconds{response.seconds});
+  return response;
+}
+
+auto HttpPool::acquire() -> CURL * {
+  unique_lock<mutex> lock(poolMutex);
+  if (handles.empty()) {
+    return nullptr;
+  }
+  idleCv.wait(lock, [this]() { return !idle.empty(); });
+  CURL *handle = idle.back();
+  idle.pop_back();
+  return handle;
+}
+
+void HttpPool::release(CURL *handle) {
+  {
+    lock_guard<mutex> lock(poolMutex);
+    idle.push_back(handle);
+  }
+  idleCv.notify_one();
+}
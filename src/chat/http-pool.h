@@ -0,0 +1,75 @@
+#pragma once
+
+#include "histogram.h"
+#include <condition_variable>
+#include <curl/curl.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Keep-alive connections to one OpenAI-compatible server. Every connection
+// is a libcurl easy handle, which keeps its TCP/TLS connection open between
+// requests, so only the first request on it pays for the handshake.
+// Requests may be sent from several threads at once, up to one per
+// connection; further callers wait for a connection to become free.
+class HttpPool {
+public:
+  struct Response {
+    long status = 0;       // HTTP status, 0 if no response
+    string body;           // empty when streamed to on_data
+    string error;          // transport error
+    double seconds = 0;    // whole request
+    double first_byte = 0; // until the first byte of the body
+    bool reused = false;   // no new connection was opened
+
+    [[nodiscard]] auto ok() const -> bool {
+      return error.empty() && status >= 200 && status < 300;
+    }
+  };
+
+  // Receives the body as it arrives; returning false aborts the request.
+  using OnData = function<bool(string_view chunk)>;
+
+  HttpPool(string base_url, string key, long timeout_ms,
+           size_t n_connections = 2);
+  ~HttpPool();
+
+  HttpPool(const HttpPool &) = delete;
+  auto operator=(const HttpPool &) -> HttpPool & = delete;
+
+  // POSTs the JSON body to base_url + path. The latency is recorded under
+  // label.
+  auto post(string_view label, string_view path, const string &body,
+            const OnData &on_data = nullptr) -> Response;
+  auto get(string_view label, string_view path) -> Response;
+
+  // Opens every connection in parallel with a GET of path, so that the
+  // first real request does not wait for DNS, TCP and TLS.
+  void warm_up(string_view path = "/models");
+
+  // Latency of the requests sent under label so far.
+  [[nodiscard]] auto latency(string_view label) const -> LatencyHistogram;
+  [[nodiscard]] auto labels() const -> vector<string>;
+  [[nodiscard]] auto size() const -> size_t { return handles.size(); }
+
+private:
+  auto perform(string_view label, string_view path, const string *body,
+               const OnData &on_data) -> Response;
+  auto acquire() -> CURL *;
+  void release(CURL *handle);
+
+  string base_url;
+  long timeout_ms;
+  curl_slist *headers = nullptr;
+
+  vector<CURL *> handles;
+  vector<CURL *> idle;
+  mutable mutex poolMutex;
+  condition_variable idleCv;
+  map<string, LatencyHistogram, less<>> histograms; // guarded by poolMutex
+};
@@ -0,0 +1,37 @@
+#include "mock-server.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Serves the mock LLM until interrupted, e.g. for
+//   speakflow --url http://127.0.0.1:8080/v1 --llm mock
+//
+//   mock_llm_server [port] [ms per token] [tokens] [ms to first token]
+
+auto main(int argc, char **argv) -> int {
+  MockLlmServer::Options options;
+  options.port = argc > 1 ? std::stoi(argv[1]) : 8080;
+  options.token_delay =
+      std::chrono::milliseconds(argc > 2 ? std::stoi(argv[2]) : 20);
+  options.n_tokens = argc > 3 ? std::stoi(argv[3]) : 32;
+  options.first_token_delay =
+      std::chrono::milliseconds(argc > 4 ? std::stoi(argv[4]) : 0);
+
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  // block before the server threads start, so that they inherit the mask
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  MockLlmServer server(options);
+  std::cout << "mock LLM at " << server.url() << std::endl;
+
+  int signal = 0;
+  sigwait(&signals, &signal);
+  server.stop();
+  std::cout << server.requests() << " requests on " << server.connections()
+            << " connections" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,229 @@
+#include "mock-server.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cctype>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <string_view>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+auto write_all(int fd, string_view data) -> bool {
+  while (!data.empty()) {
+    const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    data.remove_prefix(n);
+  }
+  return true;
+}
+
+auto write_response(int fd, string_view status, string_view type,
+                    string_view body) -> bool {
+  string response = "HTTP/1.1 ";
+  response += status;
+  response += "\r\nContent-Type: ";
+  response += type;
+  response += "\r\nContent-Length: " + to_string(body.size()) + "\r\n\r\n";
+  response += body;
+  return write_all(fd, response);
+}
+
+auto write_chunk(int fd, string_view data) -> bool {
+  char size[32];
+  const int n = snprintf(size, sizeof(size), "%zx\r\n", data.size());
+  string chunk(size, n);
+  chunk += data;
+  chunk += "\r\n";
+  return write_all(fd, chunk);
+}
+
+auto lower(string_view text) -> string {
+  string result(text);
+  transform(result.begin(), result.end(), result.begin(),
+            [](unsigned char c) { return tolower(c); });
+  return result;
+}
+
+} // namespace
+
+MockLlmServer::MockLlmServer(Options options) : options(options) {
+  listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    throw runtime_error("MockLlmServer: socket failed");
+  }
+  const int yes = 1;
+  ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(options.port);
+  socklen_t len = sizeof(addr);
+  if (::bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), len) != 0 ||
+      ::listen(listen_fd, 64) != 0 ||
+      ::getsockname(listen_fd, reinterpret_cast<sockaddr *>(&addr), &len) !=
+          0) {
+    ::close(listen_fd);
+    throw runtime_error("MockLlmServer: cannot listen on port " +
+                        to_string(options.port));
+  }
+  m_port = ntohs(addr.sin_port);
+  acceptor = thread(&MockLlmServer::accept_loop, this);
+}
+
+MockLlmServer::~MockLlmServer() { stop(); }
+
+auto MockLlmServer::url() const -> string {
+  return "http://127.0.0.1:" + to_string(m_port) + "/v1";
+}
+
+void MockLlmServer::stop() {
+  if (stopping.exchange(true)) {
+    return;
+  }
+  // wakes accept() and every recv()
+  ::shutdown(listen_fd, SHUT_RDWR);
+  acceptor.join();
+  ::close(listen_fd);
+
+  lock_guard<mutex> lock(connMutex);
+  for (int fd : client_fds) {
+    ::shutdown(fd, SHUT_RDWR);
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  for (int fd : client_fds) {
+    ::close(fd);
+  }
+}
+
+void MockLlmServer::accept_loop() {
+  while (!stopping) {
+    const int fd = ::accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (stopping) {
+        return;
+      }
+      continue;
+    }
+    // replies are written in small pieces
+    const int yes = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    n_connections.fetch_add(1, memory_order_relaxed);
+
+    lock_guard<mutex> lock(connMutex);
+    if (stopping) {
+      ::close(fd);
+      return;
+    }
+    client_fds.push_back(fd);
+    clients.emplace_back(&MockLlmServer::serve, this, fd);
+  }
+}
+
+// HTTP/1.1 with Content-Length bodies, which is all libcurl sends here.
+void MockLlmServer::serve(int fd) {
+  string buffer;
+  char data[16384];
+  while (!stopping) {
+    size_t header_end = buffer.find("\r\n\r\n");
+    while (header_end == string::npos) {
+      const ssize_t n = ::recv(fd, data, sizeof(data), 0);
+      if (n <= 0) {
+        return;
+      }
+      buffer.append(data, n);
+      header_end = buffer.find("\r\n\r\n");
+    }
+
+    const string header = lower(string_view(buffer).substr(0, header_end));
+    const string request_line = buffer.substr(0, buffer.find("\r\n"));
+    size_t content_length = 0;
+    if (const size_t pos = header.find("\r\ncontent-length:");
+        pos != string::npos) {
+      content_length = stoul(header.substr(pos + 17));
+    }
+    while (buffer.size() < header_end + 4 + content_length) {
+      const ssize_t n = ::recv(fd, data, sizeof(data), 0);
+      if (n <= 0) {
+        return;
+      }
+      buffer.append(data, n);
+    }
+    const string body = buffer.substr(header_end + 4, content_length);
+    buffer.erase(0, header_end + 4 + content_length);
+    n_requests.fetch_add(1, memory_order_relaxed);
+
+    bool ok = false;
+    if (request_line.starts_with("GET ")) {
+      ok = write_response(
+          fd, "200 OK", "application/json",
+          R"({"object":"list","data":[{"id":"mock","object":"model"}]})");
+    } else if (request_line.starts_with("POST ") &&
+               request_line.find("/chat/completions") != string::npos) {
+      ok = complete(fd, body);
+    } else {
+      ok = write_response(fd, "404 Not Found", "application/json",
+                          R"({"error":{"message":"not found"}})");
+    }
+    if (!ok || header.find("\r\nconnection: close") != string::npos) {
+      return;
+    }
+  }
+}
+
+auto MockLlmServer::complete(int fd, const string &body) -> bool {
+  const auto request = nlohmann::json::parse(body, nullptr, false);
+  if (request.is_discarded() || !request.contains("messages")) {
+    return write_response(fd, "400 Bad Request", "application/json",
+                          R"({"error":{"message":"bad request"}})");
+  }
+  const bool stream = request.value("stream", false);
+
+  this_thread::sleep_for(options.first_token_delay);
+  if (!stream) {
+    string reply;
+    for (int i = 0; i < options.n_tokens; ++i) {
+      if (i > 0) {
+        this_thread::sleep_for(options.token_delay);
+      }
+      reply += "word" + to_string(i) + " ";
+    }
+    const nlohmann::json completion = {
+        {"object", "chat.completion"},
+        {"model", request.value("model", "mock")},
+        {"choices",
+         {{{"index", 0},
+           {"message", {{"role", "assistant"}, {"content", reply}}},
+           {"finish_reason", "stop"}}}}};
+    return write_response(fd, "200 OK", "application/json", completion.dump());
+  }
+
+  if (!write_all(fd, "HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/event-stream\r\n"
+                     "Transfer-Encoding: chunked\r\n\r\n")) {
+    return false;
+  }
+  for (int i = 0; i < options.n_tokens; ++i) {
+    if (i > 0) {
+      this_thread::sleep_for(options.token_delay);
+    }
+    const nlohmann::json chunk = {
+        {"object", "chat.completion.chunk"},
+        {"choices",
+         {{{"index", 0},
+           {"delta", {{"content", "word" + to_string(i) + " "}}}}}}};
+    if (!write_chunk(fd, "data: " + chunk.dump() + "\n\n")) {
+      return false;
+    }
+  }
+  return write_chunk(fd, "data: [DONE]\n\n") && write_all(fd, "0\r\n\r\n");
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Minimal OpenAI-compatible server on 127.0.0.1 for benchmarks and offline
+// runs. POST .../chat/completions replies with n_tokens words, one every
+// token_delay, either as one chat.completion or as a server-sent event
+// stream when the request sets "stream"; any GET returns a model list.
+// Connections are kept alive, one thread per connection. POSIX only.
+class MockLlmServer {
+public:
+  struct Options {
+    int port = 0; // 0: any free port
+    chrono::milliseconds first_token_delay{0};
+    chrono::milliseconds token_delay{20};
+    int n_tokens = 32;
+  };
+
+  explicit MockLlmServer(Options options);
+  ~MockLlmServer();
+
+  MockLlmServer(const MockLlmServer &) = delete;
+  auto operator=(const MockLlmServer &) -> MockLlmServer & = delete;
+
+  [[nodiscard]] auto port() const -> int { return m_port; }
+  // Base URL to pass to Chat, e.g. http://127.0.0.1:8080/v1
+  [[nodiscard]] auto url() const -> string;
+  [[nodiscard]] auto requests() const -> uint64_t {
+    return n_requests.load(memory_order_relaxed);
+  }
+  [[nodiscard]] auto connections() const -> uint64_t {
+    return n_connections.load(memory_order_relaxed);
+  }
+
+  // Closes the listening socket and every connection.
+  void stop();
+
+private:
+  void accept_loop();
+  void serve(int fd);
+  auto complete(int fd, const string &body) -> bool;
+
+  Options options;
+  int listen_fd = -1;
+  int m_port = 0;
+  atomic<bool> stopping = false;
+  atomic<uint64_t> n_requests = 0;
+  atomic<uint64_t> n_connections = 0;
+
+  thread acceptor;
+  mutex connMutex;
+  vector<int> client_fds;
+  vector<thread> clients;
+};
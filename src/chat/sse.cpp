@@ -0,0 +1,78 @@
+#include "sse.h"
+
+#include <nlohmann/json.hpp>
+
+void SseParser::feed(string_view chunk) {
+  pending.append(chunk);
+
+  size_t begin = 0;
+  for (size_t end = pending.find('\n'); end != string::npos;
+       end = pending.find('\n', begin)) {
+    string_view l(pending.data() + begin, end - begin);
+    if (!l.empty() && l.back() == '\r') {
+      l.remove_suffix(1);
+    }
+    line(l);
+    begin = end + 1;
+  }
+  pending.erase(0, begin);
+}
+
+void SseParser::finish() {
+  if (!pending.empty()) {
+    string last = std::move(pending);
+    pending.clear();
+    line(last);
+  }
+  line({});
+}
+
+void SseParser::line(string_view l) {
+  if (l.empty()) {
+    if (has_data) {
+      on_event(data);
+    }
+    data.clear();
+    has_data = false;
+    return;
+  }
+  if (l.front() == ':') {
+    return; // comment, used as keep-alive
+  }
+
+  const size_t colon = l.find(':');
+  const string_view field = l.substr(0, colon);
+  string_view value = colon == string_view::npos ? string_view{}
+                                                 : l.substr(colon + 1);
+  if (!value.empty() && value.front() == ' ') {
+    value.remove_prefix(1);
+  }
+
+  if (field == "data") {
+    if (has_data) {
+      data += '\n';
+    }
+    data.append(value);
+    has_data = true;
+  }
+}
+
+auto chat_delta(string_view data) -> optional<string> {
+  if (data == "[DONE]") {
+    return nullopt;
+  }
+  const auto chunk = nlohmann::json::parse(data, nullptr, false);
+  if (chunk.is_discarded() || !chunk.contains("choices") ||
+      chunk["choices"].empty()) {
+    return nullopt;
+  }
+  const auto &delta = chunk["choices"][0].value("delta", nlohmann::json{});
+  if (!delta.contains("content") || !delta["content"].is_string()) {
+    return nullopt;
+  }
+  auto content = delta["content"].get<string>();
+  if (content.empty()) {
+    return nullopt;
+  }
+  return content;
+}
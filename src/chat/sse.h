@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Incremental parser for a text/event-stream body. Chunks arrive as the
+// network delivers them and may split lines and events anywhere; the data
+// of each complete event (its data: lines joined by '\n') is passed on.
+class SseParser {
+public:
+  using OnEvent = function<void(string_view data)>;
+
+  explicit SseParser(OnEvent on_event) : on_event(std::move(on_event)) {}
+
+  void feed(string_view chunk);
+  // Dispatches a last event that the body did not terminate.
+  void finish();
+
+private:
+  void line(string_view line);
+
+  OnEvent on_event;
+  string pending; // unterminated line
+  string data;    // data of the current event
+  bool has_data = false;
+};
+
+// Content of choices[0].delta in an OpenAI-compatible chat.completion.chunk.
+// nullopt for [DONE], malformed chunks and chunks without content.
+auto chat_delta(string_view data) -> optional<string>;
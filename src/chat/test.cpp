@@ -0,0 +1,120 @@
+#include "chat-context.h"
+#include "sse.h"
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <vector>
+
+// Feeds a recorded chat completion stream to SseParser cut at every possible
+// chunk size, as the network may deliver it, and checks the text is always
+// reassembled the same way. Then runs a long session through ChatContext
+// and checks the request size stays within the budget.
+
+namespace {
+
+const string body =
+    ": keep-alive\r\n"
+    "\r\n"
+    "data: {\"choices\":[{\"delta\":{\"role\":\"assistant\"}}]}\r\n"
+    "\r\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"你好\"}}]}\n"
+    "\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\", wor\"}}]}\n"
+    "\n"
+    "event: message\n"
+    "data: {\"choices\":[{\"delta\":{\"content\":\"ld\"}}]}\n"
+    "\n"
+    "data: {\"choices\":[{\"delta\":{},\"finish_reason\":\"stop\"}]}\n"
+    "\n"
+    "data: [DONE]";
+
+auto reassemble(size_t chunk_size, int &n_deltas) -> string {
+  string text;
+  n_deltas = 0;
+  SseParser parser([&](string_view data) {
+    if (auto delta = chat_delta(data)) {
+      text += *delta;
+      ++n_deltas;
+    }
+  });
+  for (size_t pos = 0; pos < body.size(); pos += chunk_size) {
+    parser.feed(string_view(body).substr(pos, chunk_size));
+  }
+  parser.finish();
+  return text;
+}
+
+// 200 turns with a 1000 token budget. Returns the largest request.
+auto long_session(ChatContext::Strategy strategy, size_t &n_evicted)
+    -> ChatContext::Usage {
+  ChatContext context("You are a helpful assistant.", 1000, strategy);
+  ChatContext::Usage largest;
+  n_evicted = 0;
+  for (int turn = 0; turn < 200; ++turn) {
+    context.add("user", "第" + to_string(turn) + "句：今天的会议讨论了什么？");
+    auto evicted = context.fit();
+    n_evicted += evicted.size();
+    if (!evicted.empty()) {
+      context.setSummary("summary of " + to_string(n_evicted) + " messages");
+    }
+    const auto usage = context.usage();
+    if (usage.tokens > largest.tokens) {
+      largest = usage;
+    }
+    context.add("assistant", string(400, 'x') + " lorem ipsum dolor sit amet");
+  }
+  return largest;
+}
+
+} // namespace
+
+auto main() -> int {
+  int failures = 0;
+  for (size_t chunk_size = 1; chunk_size <= body.size(); ++chunk_size) {
+    int n_deltas = 0;
+    const string text = reassemble(chunk_size, n_deltas);
+    if (text != "你好, world" || n_deltas != 3) {
+      std::println("chunk size {}: got \"{}\" in {} deltas", chunk_size, text,
+                   n_deltas);
+      ++failures;
+    }
+  }
+
+  // data split over several lines is joined with '\n'
+  string joined;
+  SseParser multiline([&](string_view data) { joined = data; });
+  multiline.feed("data: a\ndata:b\n\n");
+  if (joined != "a\nb") {
+    std::println("multi-line data: got \"{}\"", joined);
+    ++failures;
+  }
+
+  // ASCII words take about 4 characters a token, CJK one per character
+  if (ChatContext::approx_tokens("hello, world") != 5 ||
+      ChatContext::approx_tokens("你好，世界") != 5) {
+    std::println("approx_tokens: {} {}",
+                 ChatContext::approx_tokens("hello, world"),
+                 ChatContext::approx_tokens("你好，世界"));
+    ++failures;
+  }
+
+  for (auto strategy :
+       {ChatContext::Strategy::Window, ChatContext::Strategy::Summary}) {
+    size_t n_evicted = 0;
+    const auto largest = long_session(strategy, n_evicted);
+    std::println("{}: largest request {} messages, ~{} tokens, {} bytes",
+                 strategy == ChatContext::Strategy::Window ? "window"
+                                                           : "summary",
+                 largest.messages, largest.tokens, largest.bytes);
+    if (largest.tokens > 1000) {
+      ++failures;
+    }
+    if (strategy == ChatContext::Strategy::Summary && n_evicted == 0) {
+      std::println("summary: nothing was evicted");
+      ++failures;
+    }
+  }
+
+  std::println("{}", failures == 0 ? "all passed" : "FAILED");
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
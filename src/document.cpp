@@ -12,3 +12,8 @@ void Document::appendText(const QString &text) {
   m_text += "\n";
   emit textChanged(m_text);
 }
+
+void Document::appendChunk(const QString &text) {
+  m_text += text;
+  emit textChanged(m_text);
+}
@@ -12,6 +12,8 @@ public:
 
   void setText(const QString &text);
   void appendText(const QString &text);
+  // appends without starting a new line, for streamed replies
+  void appendChunk(const QString &text);
 
 signals:
   void textChanged(const QString &text);
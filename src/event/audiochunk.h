@@ -0,0 +1,94 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+// 不可变的共享音频片段。片段引用一块共享缓冲区中的[offset, offset + size)，
+// 复制片段或截取子片段只增加引用计数，不复制音频。
+// 句子音频从采集缓冲区取出一次，之后经事件、识别队列直到whisper_full都按引用传递。
+class AudioChunk {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  AudioChunk() = default;
+
+  // 接管samples
+  explicit AudioChunk(std::vector<float> samples, int sample_rate = 16000,
+                      Clock::time_point captured = {})
+      : m_size(samples.size()), m_sample_rate(sample_rate),
+        m_captured(captured) {
+    auto owner = std::make_shared<const std::vector<float>>(std::move(samples));
+    m_buffer = std::shared_ptr<const float>(owner, owner->data());
+  }
+
+  // buffer至少包含offset + size个采样，其生命周期由buffer的引用计数管理
+  AudioChunk(std::shared_ptr<const float> buffer, size_t offset, size_t size,
+             int sample_rate, Clock::time_point captured)
+      : m_buffer(std::move(buffer)), m_offset(offset), m_size(size),
+        m_sample_rate(sample_rate), m_captured(captured) {}
+
+  [[nodiscard]] auto data() const -> const float * {
+    return m_buffer.get() + m_offset;
+  }
+  [[nodiscard]] auto size() const -> size_t { return m_size; }
+  [[nodiscard]] auto empty() const -> bool { return m_size == 0; }
+  [[nodiscard]] auto begin() const -> const float * { return data(); }
+  [[nodiscard]] auto end() const -> const float * { return data() + m_size; }
+  [[nodiscard]] auto samples() const -> std::span<const float> {
+    return {data(), m_size};
+  }
+
+  [[nodiscard]] auto sample_rate() const -> int { return m_sample_rate; }
+  // 第一个采样的采集时间，未知时为time_point{}
+  [[nodiscard]] auto captured_at() const -> Clock::time_point {
+    return m_captured;
+  }
+  [[nodiscard]] auto duration() const -> std::chrono::duration<double> {
+    return std::chrono::duration<double>(static_cast<double>(m_size) /
+                                         m_sample_rate);
+  }
+
+  // 共享缓冲区的子片段
+  [[nodiscard]] auto slice(size_t offset, size_t size) const -> AudioChunk {
+    offset = std::min(offset, m_size);
+    size = std::min(size, m_size - offset);
+    auto captured = m_captured;
+    if (captured != Clock::time_point{}) {
+      captured += std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(static_cast<double>(offset) /
+                                        m_sample_rate));
+    }
+    return {m_buffer, m_offset + offset, size, m_sample_rate, captured};
+  }
+
+  // 拼接多个片段，只有一个片段时直接共享，不复制
+  static auto concat(std::span<const AudioChunk> chunks) -> AudioChunk {
+    if (chunks.empty()) {
+      return {};
+    }
+    if (chunks.size() == 1) {
+      return chunks.front();
+    }
+    size_t total = 0;
+    for (const auto &chunk : chunks) {
+      total += chunk.size();
+    }
+    std::vector<float> merged;
+    merged.reserve(total);
+    for (const auto &chunk : chunks) {
+      merged.insert(merged.end(), chunk.begin(), chunk.end());
+    }
+    return AudioChunk(std::move(merged), chunks.front().sample_rate(),
+                      chunks.front().captured_at());
+  }
+
+private:
+  std::shared_ptr<const float> m_buffer;
+  size_t m_offset = 0;
+  size_t m_size = 0;
+  int m_sample_rate = 16000;
+  Clock::time_point m_captured;
+};
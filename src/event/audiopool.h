@@ -0,0 +1,158 @@
+#pragma once
+#include "audiochunk.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// AudioChunk的缓冲区池。缓冲区按2的幂分级，片段的最后一个引用释放后
+// 缓冲区回到空闲链表，稳定运行时取句子音频不再分配内存。
+// shared_ptr的控制块也放在缓冲区头部，同样不分配内存。
+// 池的状态由片段共同持有，片段可以比AudioPool对象活得更久。
+class AudioPool {
+public:
+  struct Stats {
+    uint64_t chunks = 0;           // 取出的片段数
+    uint64_t samples = 0;          // 取出的采样数
+    uint64_t heap_allocations = 0; // 新分配的缓冲区数
+    size_t slabs = 0;              // 已分配的缓冲区数
+    size_t slabs_in_use = 0;       // 仍被片段引用的缓冲区数
+    size_t bytes = 0;              // 缓冲区总大小
+
+    // 每分钟音频对应的内存分配次数
+    [[nodiscard]] auto allocations_per_minute(int sample_rate) const
+        -> double {
+      if (samples == 0) {
+        return 0.0;
+      }
+      const double minutes = static_cast<double>(samples) / sample_rate / 60.0;
+      return static_cast<double>(heap_allocations) / minutes;
+    }
+  };
+
+  static constexpr size_t MIN_SLAB_SAMPLES = 4096; // 256 ms @ 16 kHz
+
+  AudioPool() : state(std::make_shared<State>()) {}
+
+  // 取一个n个采样的缓冲区，由fill(float *)写入后作为片段返回
+  template <typename Fill>
+  auto make_chunk(size_t n, int sample_rate,
+                  AudioChunk::Clock::time_point captured, Fill &&fill)
+      -> AudioChunk {
+    if (n == 0) {
+      return {};
+    }
+    Slab *slab = state->acquire(n);
+    try {
+      fill(slab->samples.get());
+    } catch (...) {
+      state->release(slab);
+      throw;
+    }
+    std::shared_ptr<const float> buffer(
+        slab->samples.get(), [](const float *) {},
+        SlabAllocator<float>(slab, state));
+    return {std::move(buffer), 0, n, sample_rate, captured};
+  }
+
+  [[nodiscard]] auto stats() const -> Stats { return state->stats(); }
+
+private:
+  struct Slab {
+    // 片段的shared_ptr控制块
+    alignas(std::max_align_t) std::byte control[64];
+    std::unique_ptr<float[]> samples;
+    size_t capacity = 0;
+    Slab *next = nullptr; // 空闲链表
+  };
+
+  class State {
+  public:
+    auto acquire(size_t n) -> Slab * {
+      const size_t level = size_class(n);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.chunks++;
+        counters.samples += n;
+        counters.slabs_in_use++;
+        if (Slab *slab = free[level]) {
+          free[level] = slab->next;
+          return slab;
+        }
+      }
+
+      auto slab = std::make_unique<Slab>();
+      slab->capacity = MIN_SLAB_SAMPLES << level;
+      slab->samples.reset(new float[slab->capacity]);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      counters.heap_allocations++;
+      counters.slabs++;
+      counters.bytes += slab->capacity * sizeof(float);
+      slabs.push_back(std::move(slab));
+      return slabs.back().get();
+    }
+
+    void release(Slab *slab) {
+      const size_t level = size_class(slab->capacity);
+      std::lock_guard<std::mutex> lock(mutex);
+      slab->next = free[level];
+      free[level] = slab;
+      counters.slabs_in_use--;
+    }
+
+    auto stats() const -> Stats {
+      std::lock_guard<std::mutex> lock(mutex);
+      return counters;
+    }
+
+  private:
+    static auto size_class(size_t n) -> size_t {
+      return n <= MIN_SLAB_SAMPLES
+                 ? 0
+                 : std::bit_width((n - 1) / MIN_SLAB_SAMPLES);
+    }
+
+    mutable std::mutex mutex;
+    std::array<Slab *, 64> free{};
+    std::vector<std::unique_ptr<Slab>> slabs;
+    Stats counters;
+  };
+
+  // 在缓冲区头部构造控制块。控制块销毁后shared_ptr才调用deallocate，
+  // 此时缓冲区才可以回到空闲链表
+  template <typename T> struct SlabAllocator {
+    using value_type = T;
+
+    SlabAllocator(Slab *slab, std::shared_ptr<State> state)
+        : slab(slab), state(std::move(state)) {}
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U> &other)
+        : slab(other.slab), state(other.state) {}
+
+    auto allocate(size_t n) -> T * {
+      static_assert(sizeof(T) <= sizeof(Slab::control));
+      static_assert(alignof(T) <= alignof(std::max_align_t));
+      if (n != 1) {
+        throw std::bad_alloc();
+      }
+      return reinterpret_cast<T *>(slab->control);
+    }
+    void deallocate(T *, size_t) { state->release(slab); }
+
+    template <typename U>
+    auto operator==(const SlabAllocator<U> &other) const -> bool {
+      return slab == other.slab;
+    }
+
+    Slab *slab;
+    std::shared_ptr<State> state;
+  };
+
+  std::shared_ptr<State> state;
+};
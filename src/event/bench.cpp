@@ -0,0 +1,196 @@
+#include "eventbus.h"
+#include "events.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <typeindex>
+
+// Compares publish throughput of EventBus with the previous implementation
+// (global mutex, map lookup, handler vector copy and make_shared per event),
+// then the publish latency seen by a producer when a subscriber is slow.
+//
+//   event_bench [publishes per thread]
+
+namespace {
+
+class LegacyEventBus {
+public:
+  using Handler = std::function<void(const std::shared_ptr<Event> &)>;
+
+  template <typename EventType> void subscribe(Handler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    handlers[typeid(EventType)].emplace_back(std::move(handler));
+  }
+
+  template <typename EventType, typename... Args> void publish(Args &&...args) {
+    auto event = std::make_shared<EventType>(std::forward<Args>(args)...);
+    std::vector<Handler> localHandlers;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = handlers.find(typeid(EventType));
+      if (it != handlers.end()) {
+        localHandlers = it->second;
+      }
+    }
+    for (auto &handler : localHandlers) {
+      handler(event);
+    }
+  }
+
+private:
+  std::map<std::type_index, std::vector<Handler>> handlers;
+  std::mutex mutex;
+};
+
+// Subscribes a few unrelated types first so the map lookup is not trivial.
+template <typename Bus, typename Subscribe>
+void populate(Bus &bus, int n_handlers, Subscribe subscribe) {
+  bus.template subscribe<DataUpdatedEvent>({});
+  bus.template subscribe<ErrorOccurredEvent>({});
+  bus.template subscribe<ServiceStatusEvent>({});
+  for (int i = 0; i < n_handlers; ++i) {
+    subscribe();
+  }
+}
+
+template <typename Publish>
+auto measure(int n_threads, long n_publishes, Publish publish) -> double {
+  const auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&]() {
+      for (long i = 0; i < n_publishes; ++i) {
+        publish();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - t0;
+  return static_cast<double>(n_threads) * n_publishes / elapsed.count();
+}
+
+void report(const std::string &name, int n_threads, int n_handlers,
+            double legacy, double typed) {
+  std::cout << name << ", " << n_threads << " threads, " << n_handlers
+            << " handlers: legacy " << legacy / 1e6 << " M/s, typed "
+            << typed / 1e6 << " M/s (" << typed / legacy << "x)\n";
+}
+
+// A subscriber that takes 2 ms per event, e.g. a GUI update, behind a
+// producer publishing every millisecond. Reports the worst publish latency.
+void slow_subscriber(const std::string &name,
+                     std::shared_ptr<Executor> executor) {
+  EventBus bus;
+  bus.subscribe<AudioPartialEvent>(
+      [](const AudioPartialEvent &) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      },
+      executor);
+
+  const AudioChunk audio(std::vector<float>(512, 0.1f));
+  std::chrono::steady_clock::duration worst{0};
+  for (int i = 0; i < 200; ++i) {
+    const auto t0 = std::chrono::steady_clock::now();
+    bus.publish<AudioPartialEvent>(audio);
+    worst = std::max(worst, std::chrono::steady_clock::now() - t0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::cout << name << ": worst publish "
+            << std::chrono::duration<double, std::micro>(worst).count()
+            << " us";
+  if (executor) {
+    std::cout << ", dropped " << executor->dropped();
+  }
+  std::cout << '\n';
+  if (auto *worker = dynamic_cast<WorkerExecutor *>(executor.get())) {
+    worker->stop();
+  }
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  const long n_publishes = argc > 1 ? std::stol(argv[1]) : 1'000'000;
+  std::atomic<size_t> sink{0};
+
+  for (int n_threads : {1, 4}) {
+    for (int n_handlers : {1, 4}) {
+      // small event, as published for service control
+      {
+        LegacyEventBus legacy;
+        populate(legacy, n_handlers, [&]() {
+          legacy.subscribe<StartServiceEvent>(
+              [&sink](const std::shared_ptr<Event> &event) {
+                auto startEvent =
+                    std::static_pointer_cast<StartServiceEvent>(event);
+                sink.fetch_add(startEvent->serviceName.size(),
+                               std::memory_order_relaxed);
+              });
+        });
+        EventBus typed;
+        populate(typed, n_handlers, [&]() {
+          typed.subscribe<StartServiceEvent>(
+              [&sink](const StartServiceEvent &startEvent) {
+                sink.fetch_add(startEvent.serviceName.size(),
+                               std::memory_order_relaxed);
+              });
+        });
+
+        const double a = measure(n_threads, n_publishes, [&]() {
+          legacy.publish<StartServiceEvent>("stt");
+        });
+        const double b = measure(n_threads, n_publishes, [&]() {
+          typed.publish<StartServiceEvent>("stt");
+        });
+        report("StartServiceEvent", n_threads, n_handlers, a, b);
+      }
+
+      // 32 ms of audio, as published for every partial sentence update
+      {
+        const AudioChunk audio(std::vector<float>(512, 0.1f));
+        LegacyEventBus legacy;
+        populate(legacy, n_handlers, [&]() {
+          legacy.subscribe<AudioPartialEvent>(
+              [&sink](const std::shared_ptr<Event> &event) {
+                auto audioEvent =
+                    std::static_pointer_cast<AudioPartialEvent>(event);
+                sink.fetch_add(audioEvent->audio.size(),
+                               std::memory_order_relaxed);
+              });
+        });
+        EventBus typed;
+        populate(typed, n_handlers, [&]() {
+          typed.subscribe<AudioPartialEvent>(
+              [&sink](const AudioPartialEvent &audioEvent) {
+                sink.fetch_add(audioEvent.audio.size(),
+                               std::memory_order_relaxed);
+              });
+        });
+
+        const double a = measure(n_threads, n_publishes / 4, [&]() {
+          legacy.publish<AudioPartialEvent>(audio);
+        });
+        const double b = measure(n_threads, n_publishes / 4, [&]() {
+          typed.publish<AudioPartialEvent>(audio);
+        });
+        report("AudioPartialEvent", n_threads, n_handlers, a, b);
+      }
+    }
+  }
+
+  slow_subscriber("inline", nullptr);
+  slow_subscriber("worker, drop oldest",
+                  std::make_shared<WorkerExecutor>(16, Overflow::DropOldest));
+  slow_subscriber("worker, block",
+                  std::make_shared<WorkerExecutor>(16, Overflow::Block));
+
+  // keep the handlers from being optimized away
+  std::cerr << "checksum " << sink.load() << '\n';
+  return 0;
+}
@@ -1,9 +1,12 @@
 #pragma once
+#include "executor.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
-#include <typeindex>
+#include <stdexcept>
 #include <vector>
 
 class Event {
@@ -11,32 +14,113 @@ public:
   virtual ~Event() = default;
 };
 
-using EventHandler = std::function<void(const std::shared_ptr<Event> &)>;
+template <typename EventType>
+using EventHandler = std::function<void(const EventType &)>;
 
-class EventBus {
-  std::map<std::type_index, std::vector<EventHandler>> handlers;
-  std::mutex mutex;
+namespace detail {
+
+inline auto next_event_type_id() -> size_t {
+  static std::atomic<size_t> next{0};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 每种事件类型一个固定下标，首次使用时分配，之后不再变化
+template <typename EventType> auto event_type_id() -> size_t {
+  static const size_t id = next_event_type_id();
+  return id;
+}
 
+} // namespace detail
+
+// 发布不加锁、不拷贝处理函数：每种事件的处理函数列表是只读快照，
+// 订阅时复制出新列表再原子地替换(RCU)。旧快照可能仍在被发布线程遍历，
+// 或被执行器中尚未执行的事件引用，因此保留到总线析构时才释放，
+// 订阅只在初始化阶段发生，开销可以忽略。执行器需在总线析构前停止。
+class EventBus {
 public:
-  template <typename EventType> void subscribe(EventHandler handler) {
+  static constexpr size_t MAX_EVENT_TYPES = 64;
+
+  EventBus() = default;
+  EventBus(const EventBus &) = delete;
+  auto operator=(const EventBus &) -> EventBus & = delete;
+
+  // executor为空时处理函数在发布者线程中同步执行，
+  // 否则投递到执行器中执行，发布者只等待入队
+  template <typename EventType>
+  void subscribe(EventHandler<EventType> handler,
+                 std::shared_ptr<Executor> executor = nullptr) {
+    const size_t id = detail::event_type_id<EventType>();
+    if (id >= MAX_EVENT_TYPES) {
+      throw std::length_error("EventBus: too many event types");
+    }
+
     std::lock_guard<std::mutex> lock(mutex);
-    handlers[typeid(EventType)].emplace_back(std::move(handler));
+    auto next = std::make_unique<HandlerList<EventType>>();
+    if (const auto *current = static_cast<const HandlerList<EventType> *>(
+            slots[id].load(std::memory_order_relaxed))) {
+      next->subscribers = current->subscribers;
+      next->async = current->async;
+    }
+    next->async = next->async || executor != nullptr;
+    next->subscribers.push_back({std::move(handler), std::move(executor)});
+
+    slots[id].store(next.get(), std::memory_order_release);
+    snapshots.push_back(std::move(next));
   }
 
+  // 没有订阅者时不构造事件；有异步订阅者时事件只构造一次，所有订阅者共享
   template <typename EventType, typename... Args> void publish(Args &&...args) {
-    auto event = std::make_shared<EventType>(std::forward<Args>(args)...);
-    std::vector<EventHandler> localHandlers;
-
-    {
-      std::lock_guard<std::mutex> lock(mutex);
-      auto it = handlers.find(typeid(EventType));
-      if (it != handlers.end()) {
-        localHandlers = it->second;
+    const size_t id = detail::event_type_id<EventType>();
+    if (id >= MAX_EVENT_TYPES) {
+      return;
+    }
+    const auto *list = static_cast<const HandlerList<EventType> *>(
+        slots[id].load(std::memory_order_acquire));
+    if (list == nullptr) {
+      return;
+    }
+
+    if (!list->async) {
+      const EventType event(std::forward<Args>(args)...);
+      for (const auto &subscriber : list->subscribers) {
+        subscriber.handler(event);
       }
+      return;
     }
 
-    for (auto &handler : localHandlers) {
-      handler(event);
+    auto event = std::make_shared<const EventType>(std::forward<Args>(args)...);
+    for (const auto &subscriber : list->subscribers) {
+      if (subscriber.executor) {
+        subscriber.executor->post(
+            {&invoke<EventType>, &subscriber.handler, event});
+      } else {
+        subscriber.handler(*event);
+      }
     }
   }
+
+private:
+  struct HandlerListBase {
+    virtual ~HandlerListBase() = default;
+  };
+
+  template <typename EventType> struct Subscriber {
+    EventHandler<EventType> handler;
+    std::shared_ptr<Executor> executor;
+  };
+
+  template <typename EventType> struct HandlerList : HandlerListBase {
+    std::vector<Subscriber<EventType>> subscribers;
+    bool async = false; // 至少一个订阅者使用执行器
+  };
+
+  template <typename EventType>
+  static void invoke(const void *handler, const void *event) {
+    (*static_cast<const EventHandler<EventType> *>(handler))(
+        *static_cast<const EventType *>(event));
+  }
+
+  std::array<std::atomic<const HandlerListBase *>, MAX_EVENT_TYPES> slots{};
+  std::mutex mutex; // 串行化订阅
+  std::vector<std::unique_ptr<HandlerListBase>> snapshots;
 };
@@ -1,6 +1,10 @@
 #pragma once
+#include "audiochunk.h"
 #include "eventbus.h"
+#include "trace.h"
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <string>
 
 // 数据更新事件
@@ -13,17 +17,48 @@ public:
       : dataType(std::move(type)), newValue(value) {}
 };
 
+// 句子编号，进程内唯一，从1开始；0表示无
+inline auto next_sentence_id() -> uint64_t {
+  static std::atomic<uint64_t> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
 class AudioAddedEvent : public Event {
 public:
-  std::vector<float> audio;
-  AudioAddedEvent(std::vector<float> audio_data)
-      : audio(std::move(audio_data)) {}
+  AudioChunk audio;
+  int stream_id; // 音频源编号，见Sentense的inputs
+  uint64_t id;   // 句子编号，删除、移动句子时使用
+  AudioAddedEvent(AudioChunk audio_data, int stream = 0,
+                  uint64_t sentence_id = next_sentence_id())
+      : audio(std::move(audio_data)), stream_id(stream), id(sentence_id) {}
+
+  [[nodiscard]] auto trace() const -> Trace {
+    return {id, audio.captured_at()};
+  }
+};
+
+// 正在进行中的句子新采集到的音频(增量)，句子结束时以AudioAddedEvent收尾
+class AudioPartialEvent : public Event {
+public:
+  AudioChunk audio;
+  int stream_id;
+  AudioPartialEvent(AudioChunk audio_data, int stream = 0)
+      : audio(std::move(audio_data)), stream_id(stream) {}
 };
 
 class AudioRemovedEvent : public Event {
 public:
-  size_t index;
-  AudioRemovedEvent(size_t i) : index(i) {}
+  uint64_t id; // AudioAddedEvent::id
+  explicit AudioRemovedEvent(uint64_t sentence_id) : id(sentence_id) {}
+};
+
+// 把句子移动到before_id之前，before_id为0时移到末尾
+class AudioMovedEvent : public Event {
+public:
+  uint64_t id;
+  uint64_t before_id;
+  AudioMovedEvent(uint64_t sentence_id, uint64_t before)
+      : id(sentence_id), before_id(before) {}
 };
 
 class AudioClearedEvent : public Event {
@@ -40,9 +75,38 @@ class MessageAddedEvent : public Event {
 public:
   std::string serviceName;
   std::string message;
+  int stream_id; // 识别结果对应的音频源
+  Trace trace;   // 识别结果对应的句子
+
+  MessageAddedEvent(std::string name, std::string msg, int stream = 0,
+                    Trace message_trace = {})
+      : serviceName(std::move(name)), message(std::move(msg)),
+        stream_id(stream), trace(message_trace) {}
+};
+
+// 尚未结束的句子的临时识别结果，空字符串表示清除
+class MessagePartialEvent : public Event {
+public:
+  std::string serviceName;
+  std::string message;
+  int stream_id;
+
+  MessagePartialEvent(std::string name, std::string msg, int stream = 0)
+      : serviceName(std::move(name)), message(std::move(msg)),
+        stream_id(stream) {}
+};
+
+// 流式回复的增量文本，按到达顺序发布。done为true的事件表示本次回复结束，
+// 此时delta为空
+class MessageDeltaEvent : public Event {
+public:
+  std::string serviceName;
+  std::string delta;
+  bool done;
 
-  MessageAddedEvent(std::string name, std::string msg)
-      : serviceName(std::move(name)), message(std::move(msg)) {}
+  MessageDeltaEvent(std::string name, std::string text, bool finished = false)
+      : serviceName(std::move(name)), delta(std::move(text)),
+        done(finished) {}
 };
 
 class MessageClearedEvent : public Event {
@@ -0,0 +1,176 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 一次异步的事件处理：handler和event的具体类型由invoke还原。
+// 事件对所有异步订阅者共享，投递时不复制事件、不分配内存。
+struct EventTask {
+  void (*invoke)(const void *handler, const void *event) = nullptr;
+  const void *handler = nullptr;
+  std::shared_ptr<const void> event;
+
+  void operator()() const { invoke(handler, event.get()); }
+};
+
+// 队列满时的处理策略
+enum class Overflow {
+  Block,      // 发布者等待空位(背压)，不丢事件
+  DropNewest, // 丢弃新事件
+  DropOldest, // 丢弃最早的事件
+};
+
+// 订阅时指定执行器，事件处理函数在执行器中运行，发布者不再等待处理函数。
+// 不指定执行器(nullptr)时处理函数在发布者线程中同步执行。
+class Executor {
+public:
+  virtual ~Executor() = default;
+  virtual void post(EventTask task) = 0;
+  // 因队列满而丢弃的事件数
+  [[nodiscard]] virtual auto dropped() const -> uint64_t = 0;
+};
+
+// 有界多生产者单消费者队列，槽位预先分配
+class TaskQueue {
+public:
+  TaskQueue(size_t capacity, Overflow policy)
+      : ring(capacity > 0 ? capacity : 1), policy(policy) {}
+
+  // 返回false表示事件被丢弃或队列已关闭
+  auto push(EventTask task) -> bool {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (closed) {
+        return false;
+      }
+      if (count == ring.size()) {
+        switch (policy) {
+        case Overflow::Block:
+          notFull.wait(lock,
+                       [this]() { return count < ring.size() || closed; });
+          if (closed) {
+            return false;
+          }
+          break;
+        case Overflow::DropNewest:
+          droppedCount.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        case Overflow::DropOldest:
+          ring[head] = {};
+          head = (head + 1) % ring.size();
+          --count;
+          droppedCount.fetch_add(1, std::memory_order_relaxed);
+          break;
+        }
+      }
+      ring[(head + count) % ring.size()] = std::move(task);
+      ++count;
+    }
+    notEmpty.notify_one();
+    return true;
+  }
+
+  // 等待下一个事件，队列关闭后返回false
+  auto pop(EventTask &task) -> bool {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this]() { return count > 0 || closed; });
+    if (closed) {
+      return false;
+    }
+    take(task);
+    lock.unlock();
+    notFull.notify_one();
+    return true;
+  }
+
+  auto try_pop(EventTask &task) -> bool {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (count == 0) {
+        return false;
+      }
+      take(task);
+    }
+    notFull.notify_one();
+    return true;
+  }
+
+  // 丢弃剩余事件并唤醒所有等待者
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+      for (; count > 0; --count) {
+        ring[head] = {};
+        head = (head + 1) % ring.size();
+      }
+    }
+    notEmpty.notify_all();
+    notFull.notify_all();
+  }
+
+  [[nodiscard]] auto dropped() const -> uint64_t {
+    return droppedCount.load(std::memory_order_relaxed);
+  }
+
+private:
+  void take(EventTask &task) {
+    task = std::move(ring[head]);
+    head = (head + 1) % ring.size();
+    --count;
+  }
+
+  std::vector<EventTask> ring;
+  size_t head = 0;
+  size_t count = 0;
+  bool closed = false;
+  const Overflow policy;
+  std::atomic<uint64_t> droppedCount = 0;
+
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+};
+
+// 独立线程按发布顺序执行事件处理函数
+class WorkerExecutor : public Executor {
+public:
+  explicit WorkerExecutor(size_t capacity = 256,
+                          Overflow policy = Overflow::Block)
+      : queue(capacity, policy), worker(&WorkerExecutor::run, this) {}
+  ~WorkerExecutor() override { stop(); }
+
+  WorkerExecutor(const WorkerExecutor &) = delete;
+  auto operator=(const WorkerExecutor &) -> WorkerExecutor & = delete;
+
+  void post(EventTask task) override { queue.push(std::move(task)); }
+
+  [[nodiscard]] auto dropped() const -> uint64_t override {
+    return queue.dropped();
+  }
+
+  // 等待正在执行的处理函数结束，丢弃尚未执行的事件
+  void stop() {
+    queue.close();
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+private:
+  void run() {
+    EventTask task;
+    while (queue.pop(task)) {
+      task();
+      task = {};
+    }
+  }
+
+  TaskQueue queue;
+  std::thread worker;
+};
@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// 对数分桶的延迟直方图，内存固定，记录和查询分位数都不分配内存。
+// 每个2倍区间分4个桶，范围1us到约18min，分位数的相对误差不超过约10%。
+// 不加锁，由使用者同步。
+class LatencyHistogram {
+public:
+  using Seconds = std::chrono::duration<double>;
+
+  static constexpr int BUCKETS_PER_OCTAVE = 4;
+  static constexpr size_t N_BUCKETS = 30 * BUCKETS_PER_OCTAVE;
+
+  using Buckets = std::array<uint64_t, N_BUCKETS>;
+
+  LatencyHistogram() = default;
+
+  // 由各桶的计数构造，供并发记录的直方图(见metrics.h)取快照
+  LatencyHistogram(const Buckets &counts, double sum_seconds,
+                   double max_latency)
+      : buckets(counts), sum(sum_seconds), max_seconds(max_latency) {
+    for (auto count : buckets) {
+      n += count;
+    }
+  }
+
+  static auto bucket_of(Seconds latency) -> size_t {
+    const double us = std::max(latency.count() * 1e6, 1.0);
+    const auto index = static_cast<size_t>(std::log2(us) * BUCKETS_PER_OCTAVE);
+    return std::min(index, N_BUCKETS - 1);
+  }
+
+  void record(Seconds latency) {
+    buckets[bucket_of(latency)]++;
+    n++;
+    sum += latency.count();
+    max_seconds = std::max(max_seconds, latency.count());
+  }
+
+  void merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < N_BUCKETS; ++i) {
+      buckets[i] += other.buckets[i];
+    }
+    n += other.n;
+    sum += other.sum;
+    max_seconds = std::max(max_seconds, other.max_seconds);
+  }
+
+  // 从earlier(同一直方图较早的快照)到现在新增的记录。最大值无法相减，
+  // 沿用现在的最大值
+  [[nodiscard]] auto since(const LatencyHistogram &earlier) const
+      -> LatencyHistogram {
+    LatencyHistogram result = *this;
+    for (size_t i = 0; i < N_BUCKETS; ++i) {
+      result.buckets[i] -= std::min(earlier.buckets[i], buckets[i]);
+    }
+    result.n -= std::min(earlier.n, n);
+    result.sum -= earlier.sum;
+    return result;
+  }
+
+  // p取0到1，返回所在桶的几何中点
+  [[nodiscard]] auto percentile(double p) const -> Seconds {
+    if (n == 0) {
+      return Seconds{0};
+    }
+    const auto rank = static_cast<uint64_t>(std::ceil(p * n));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < N_BUCKETS; ++i) {
+      seen += buckets[i];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        const double us =
+            std::exp2((i + 0.5) / static_cast<double>(BUCKETS_PER_OCTAVE));
+        return Seconds{std::min(us * 1e-6, max_seconds)};
+      }
+    }
+    return Seconds{max_seconds};
+  }
+
+  [[nodiscard]] auto count() const -> uint64_t { return n; }
+  [[nodiscard]] auto mean() const -> Seconds {
+    return Seconds{n == 0 ? 0.0 : sum / static_cast<double>(n)};
+  }
+  [[nodiscard]] auto max() const -> Seconds { return Seconds{max_seconds}; }
+
+private:
+  Buckets buckets{};
+  uint64_t n = 0;
+  double sum = 0.0;
+  double max_seconds = 0.0;
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include "histogram.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 计数器，只增不减，显示为每秒的增量
+class Counter {
+public:
+  void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+  [[nodiscard]] auto value() const -> uint64_t {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> value_{0};
+};
+
+// 瞬时值，如队列长度，显示最近一次设置的值
+class Gauge {
+public:
+  void set(double value) { value_.store(value, std::memory_order_relaxed); }
+  [[nodiscard]] auto value() const -> double {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<double> value_{0.0};
+};
+
+// 分桶与LatencyHistogram相同，每个桶是原子计数，多个线程可同时记录
+class Histogram {
+public:
+  using Seconds = LatencyHistogram::Seconds;
+
+  void record(Seconds latency) {
+    buckets[LatencyHistogram::bucket_of(latency)].fetch_add(
+        1, std::memory_order_relaxed);
+    sum.fetch_add(latency.count(), std::memory_order_relaxed);
+    double max = max_seconds.load(std::memory_order_relaxed);
+    while (latency.count() > max &&
+           !max_seconds.compare_exchange_weak(max, latency.count(),
+                                              std::memory_order_relaxed)) {
+    }
+  }
+
+  // 各桶分别读取，与并发的记录之间不是严格一致的快照
+  [[nodiscard]] auto snapshot() const -> LatencyHistogram {
+    LatencyHistogram::Buckets counts{};
+    for (size_t i = 0; i < counts.size(); ++i) {
+      counts[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    return {counts, sum.load(std::memory_order_relaxed),
+            max_seconds.load(std::memory_order_relaxed)};
+  }
+
+private:
+  std::array<std::atomic<uint64_t>, LatencyHistogram::N_BUCKETS> buckets{};
+  std::atomic<double> sum{0.0};
+  std::atomic<double> max_seconds{0.0};
+};
+
+// 进程内的运行指标，按名称注册。注册时加锁，返回的引用在进程内一直有效，
+// 各模块在初始化时取得引用，之后更新只是一次原子操作。
+// 名称以模块名开头，如"stt.queue"。
+class Metrics {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static auto instance() -> Metrics & {
+    static Metrics metrics;
+    return metrics;
+  }
+
+  auto counter(const std::string &name) -> Counter & {
+    return find(counters, name);
+  }
+  auto gauge(const std::string &name) -> Gauge & { return find(gauges, name); }
+  auto histogram(const std::string &name) -> Histogram & {
+    return find(histograms, name);
+  }
+
+  struct Snapshot {
+    Clock::time_point at;
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, double> gauges;
+    std::map<std::string, LatencyHistogram> histograms;
+
+    // 从earlier到这次快照之间可以绘制的值：计数器为每秒增量("/s")，
+    // 瞬时值原样，直方图为期间新增记录的p50和p99(毫秒)，期间没有记录时跳过
+    [[nodiscard]] auto values_since(const Snapshot &earlier) const
+        -> std::vector<std::pair<std::string, double>> {
+      std::vector<std::pair<std::string, double>> values;
+      const double seconds =
+          std::chrono::duration<double>(at - earlier.at).count();
+      for (const auto &[name, value] : counters) {
+        auto it = earlier.counters.find(name);
+        if (it != earlier.counters.end() && seconds > 0) {
+          values.emplace_back(name + " /s", (value - it->second) / seconds);
+        }
+      }
+      for (const auto &[name, value] : gauges) {
+        values.emplace_back(name, value);
+      }
+      for (const auto &[name, histogram] : histograms) {
+        auto it = earlier.histograms.find(name);
+        const auto recent =
+            it == earlier.histograms.end() ? histogram
+                                           : histogram.since(it->second);
+        if (recent.count() > 0) {
+          values.emplace_back(name + " p50 ms",
+                              recent.percentile(0.5).count() * 1e3);
+          values.emplace_back(name + " p99 ms",
+                              recent.percentile(0.99).count() * 1e3);
+        }
+      }
+      return values;
+    }
+  };
+
+  [[nodiscard]] auto snapshot() const -> Snapshot {
+    Snapshot result;
+    result.at = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[name, counter] : counters) {
+      result.counters.emplace(name, counter->value());
+    }
+    for (const auto &[name, gauge] : gauges) {
+      result.gauges.emplace(name, gauge->value());
+    }
+    for (const auto &[name, histogram] : histograms) {
+      result.histograms.emplace(name, histogram->snapshot());
+    }
+    return result;
+  }
+
+private:
+  template <typename T>
+  auto find(std::map<std::string, std::unique_ptr<T>> &metrics,
+            const std::string &name) -> T & {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &metric = metrics[name];
+    if (!metric) {
+      metric = std::make_unique<T>();
+    }
+    return *metric;
+  }
+
+  mutable std::mutex mutex;
+  std::map<std::string, std::unique_ptr<Counter>> counters;
+  std::map<std::string, std::unique_ptr<Gauge>> gauges;
+  std::map<std::string, std::unique_ptr<Histogram>> histograms;
+};
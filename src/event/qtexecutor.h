@@ -0,0 +1,53 @@
+#pragma once
+#include "executor.h"
+#include <QMetaObject>
+#include <QObject>
+#include <QThread>
+
+// 在context所在的Qt线程(通常是GUI线程)中执行事件处理函数。
+// 事件先进入有界队列，队列由空变为非空时投递一次排队调用，一次取完。
+// 执行器应作为context的成员，与context同时销毁。
+class QtExecutor : public Executor {
+public:
+  explicit QtExecutor(QObject *context, size_t capacity = 1024,
+                      Overflow policy = Overflow::DropOldest)
+      : context(context), queue(capacity, policy) {}
+  ~QtExecutor() override { queue.close(); }
+
+  QtExecutor(const QtExecutor &) = delete;
+  auto operator=(const QtExecutor &) -> QtExecutor & = delete;
+
+  void post(EventTask task) override {
+    if (QThread::currentThread() == context->thread()) {
+      // 已在目标线程中：先执行排队的事件以保持顺序，也避免Block策略自锁
+      drain();
+      task();
+      return;
+    }
+    if (!queue.push(std::move(task))) {
+      return;
+    }
+    if (!scheduled.exchange(true)) {
+      QMetaObject::invokeMethod(
+          context, [this]() { drain(); }, Qt::QueuedConnection);
+    }
+  }
+
+  [[nodiscard]] auto dropped() const -> uint64_t override {
+    return queue.dropped();
+  }
+
+private:
+  void drain() {
+    // 先清除标记再取事件，取完之后的新事件会重新投递
+    scheduled = false;
+    EventTask task;
+    while (queue.try_pop(task)) {
+      task();
+    }
+  }
+
+  QObject *context;
+  TaskQueue queue;
+  std::atomic<bool> scheduled = false;
+};
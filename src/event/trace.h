@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 跟踪一句话从采集到AI回复经过的各个阶段。句子编号即跟踪编号，
+// 多句合并识别时沿用第一句的编号；captured为第一个采样的采集时间。
+struct Trace {
+  uint64_t id = 0; // 0表示不跟踪
+  std::chrono::steady_clock::time_point captured{};
+};
+
+// 阶段耗时(span)记录在固定大小的环形缓冲区中，满了覆盖最早的记录。
+// 记录只有一次fetch_add和几次原子写，不加锁、不分配内存，未开启时直接返回。
+// 每个槽位带序号，导出时跳过正在写或已被覆盖的槽位。
+class Tracer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Span {
+    const char *name; // 必须是字符串常量
+    uint64_t trace_id;
+    Clock::time_point start;
+    Clock::time_point end;
+    int stream_id;
+  };
+
+  static auto instance() -> Tracer & {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  // 在启动阶段、记录开始前调用一次，capacity向上取2的幂
+  void enable(size_t capacity = 1 << 16) {
+    size_t n = 1;
+    while (n < capacity) {
+      n <<= 1;
+    }
+    slots = std::make_unique<Slot[]>(n);
+    mask = n - 1;
+    on.store(true, std::memory_order_release);
+  }
+
+  [[nodiscard]] auto enabled() const -> bool {
+    return on.load(std::memory_order_acquire);
+  }
+
+  void record(const char *name, uint64_t trace_id, Clock::time_point start,
+              Clock::time_point end, int stream_id = 0) {
+    if (trace_id == 0 || !enabled()) {
+      return;
+    }
+    const uint64_t index = next.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = slots[index & mask];
+    // 奇数表示正在写
+    slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.trace_id.store(trace_id, std::memory_order_relaxed);
+    slot.start.store(start.time_since_epoch().count(),
+                     std::memory_order_relaxed);
+    slot.end.store(end.time_since_epoch().count(), std::memory_order_relaxed);
+    slot.stream_id.store(stream_id, std::memory_order_relaxed);
+    slot.seq.store(2 * index + 2, std::memory_order_release);
+  }
+
+  // 从开始到现在的耗时
+  void record(const char *name, const Trace &trace, Clock::time_point start,
+              int stream_id = 0) {
+    record(name, trace.id, start, Clock::now(), stream_id);
+  }
+
+  // 缓冲区中完整的记录，从早到晚
+  [[nodiscard]] auto spans() const -> std::vector<Span> {
+    std::vector<Span> result;
+    if (!enabled()) {
+      return result;
+    }
+    const uint64_t last = next.load(std::memory_order_acquire);
+    const uint64_t first = last > mask + 1 ? last - (mask + 1) : 0;
+    result.reserve(last - first);
+    for (uint64_t index = first; index < last; ++index) {
+      const Slot &slot = slots[index & mask];
+      const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+      Span span{slot.name.load(std::memory_order_relaxed),
+                slot.trace_id.load(std::memory_order_relaxed),
+                Clock::time_point(Clock::duration(
+                    slot.start.load(std::memory_order_relaxed))),
+                Clock::time_point(
+                    Clock::duration(slot.end.load(std::memory_order_relaxed))),
+                slot.stream_id.load(std::memory_order_relaxed)};
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq == 2 * index + 2 &&
+          slot.seq.load(std::memory_order_relaxed) == seq) {
+        result.push_back(span);
+      }
+    }
+    return result;
+  }
+
+  // 导出为Chrome trace格式(chrome://tracing或ui.perfetto.dev打开)，
+  // 每个跟踪编号一行，时间单位为微秒
+  auto write_chrome_trace(const std::string &path) const -> bool {
+    std::ofstream out(path);
+    if (!out) {
+      return false;
+    }
+    auto us = [](Clock::time_point t) {
+      return std::chrono::duration_cast<std::chrono::microseconds>(
+                 t.time_since_epoch())
+          .count();
+    };
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto &span : spans()) {
+      out << (first ? "\n" : ",\n") << "{\"name\":\"" << span.name
+          << "\",\"cat\":\"pipeline\",\"ph\":\"X\",\"ts\":" << us(span.start)
+          << ",\"dur\":" << us(span.end) - us(span.start)
+          << ",\"pid\":1,\"tid\":" << span.trace_id
+          << ",\"args\":{\"stream\":" << span.stream_id << "}}";
+      first = false;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> trace_id{0};
+    std::atomic<Clock::rep> start{0};
+    std::atomic<Clock::rep> end{0};
+    std::atomic<int> stream_id{0};
+  };
+
+  std::unique_ptr<Slot[]> slots;
+  uint64_t mask = 0;
+  std::atomic<uint64_t> next{0};
+  std::atomic<bool> on{false};
+};
@@ -2,20 +2,18 @@
 #define MAINWINDOW_H
 
 #include "cardman.h"
-#include "chat.h"
 #include "document.h"
 #include "eventbus.h"
 #include "monitorwindow.h"
 #include "parse.h"
+#include "pipeline.h"
 #include "previewpage.h"
-#include "sentense.h"
-#include "stt.h"
+#include "qtexecutor.h"
 
 #include <QMainWindow>
 #include <QString>
 #include <QTimer>
 #include <memory>
-#include <whisper.h>
 
 using namespace std;
 
@@ -35,23 +33,18 @@ public:
 
 private:
   whisper_params params;
-  whisper_full_params wparams;
-  whisper_context_params cparams;
 
+  // 采集、识别和对话，界面只订阅其中的事件
+  Pipeline pipeline;
   std::shared_ptr<EventBus> eventBus;
+  std::shared_ptr<QtExecutor> guiExecutor;
 
-  Sentense sentense;
-  bool is_running = false;
   Document m_content;
 
   unique_ptr<Ui::MainWindow> ui;
   unique_ptr<PreviewPage> page;
-  unique_ptr<Chat> chat;
-  unique_ptr<STT> stt;
   unique_ptr<MonitorWindow> monitorwindow;
 
   unique_ptr<CardMan> audio_Man;
-
-  void set_params();
 };
 #endif // MAINWINDOW_H
@@ -1,17 +1,23 @@
 #include "monitorwindow.h"
 #include "ui_monitorwindow.h"
 #include <QChartView>
+#include <QLegendMarker>
 #include <QScatterSeries> // 加这个！
+#include <QSplitter>
+#include <algorithm>
+#include <limits>
 
 MonitorWindow::MonitorWindow(QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MonitorWindow) {
   ui->setupUi(this);
+  setWindowTitle("Monitor");
 
   series = new QScatterSeries(); // 改这里！
+  points.series = series;
 
   chart = new QChart();
   chart->addSeries(series);
-  chart->legend()->hide();
+  chart->legend()->setAlignment(Qt::AlignBottom);
   // chart->createDefaultAxes();
 
   axisX = new QValueAxis;
@@ -20,17 +26,37 @@ MonitorWindow::MonitorWindow(QWidget *parent)
   chart->addAxis(axisY, Qt::AlignLeft);
   series->attachAxis(axisX);
   series->attachAxis(axisY);
+  chart->legend()->markers(series).first()->setVisible(false);
 
-  axisX->setTitleText("Time");
+  axisX->setTitleText("Time (s)");
   axisY->setTitleText("Value");
 
   chartView = new QChartView(chart);
-  setCentralWidget(chartView);
+  metricList = new QListWidget;
+  metricList->setSortingEnabled(true);
+  connect(metricList, &QListWidget::itemChanged, this,
+          &MonitorWindow::show_line);
 
-  axisX->setRange(0, 30);
+  auto *splitter = new QSplitter;
+  splitter->addWidget(metricList);
+  splitter->addWidget(chartView);
+  splitter->setStretchFactor(1, 1);
+  setCentralWidget(splitter);
+
+  axisX->setRange(0, WINDOW_SECONDS);
   axisY->setRange(-1, 3);
 
   start_time = high_resolution_clock::now();
+
+  last = Metrics::instance().snapshot();
+  timer = new QTimer(this);
+  connect(timer, &QTimer::timeout, this, &MonitorWindow::refresh);
+  timer->start(REFRESH_MS);
+
+  frameTimer = new QTimer(this);
+  frameTimer->setSingleShot(true);
+  frameTimer->setInterval(FRAME_MS);
+  connect(frameTimer, &QTimer::timeout, this, &MonitorWindow::render);
 }
 
 void MonitorWindow::add_point(high_resolution_clock::time_point t_now,
@@ -41,11 +67,110 @@ void MonitorWindow::add_point(high_resolution_clock::time_point t_now,
 
   double time_in_seconds = duration.count();
 
-  series->append(time_in_seconds, value);
+  points.samples.append(time_in_seconds, value);
+  request_render();
+}
+
+void MonitorWindow::showEvent(QShowEvent *event) {
+  QMainWindow::showEvent(event);
+  render();
+}
+
+auto MonitorWindow::now() const -> double {
+  return duration<double>(high_resolution_clock::now() - start_time).count();
+}
+
+void MonitorWindow::refresh() {
+  auto snapshot = Metrics::instance().snapshot();
+  const double t = now();
+  for (const auto &[name, value] : snapshot.values_since(last)) {
+    line_of(QString::fromStdString(name)).samples.append(t, value);
+  }
+  last = std::move(snapshot);
+  request_render();
+}
+
+auto MonitorWindow::line_of(const QString &name) -> Line & {
+  auto it = lines.find(name);
+  if (it != lines.end()) {
+    return it->second;
+  }
+
+  auto *line = new QLineSeries;
+  line->setName(name);
+  line->setVisible(false);
+  chart->addSeries(line);
+  line->attachAxis(axisX);
+  line->attachAxis(axisY);
+  chart->legend()->markers(line).first()->setVisible(false);
+
+  auto *item = new QListWidgetItem(name);
+  item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+  item->setCheckState(Qt::Unchecked);
+  metricList->addItem(item);
+
+  auto &result = lines[name];
+  result.series = line;
+  return result;
+}
+
+void MonitorWindow::show_line(QListWidgetItem *item) {
+  auto it = lines.find(item->text());
+  if (it == lines.end()) {
+    return;
+  }
+  auto *line = it->second.series;
+  const bool checked = item->checkState() == Qt::Checked;
+  line->setVisible(checked);
+  chart->legend()->markers(line).first()->setVisible(checked);
+  if (!checked) {
+    line->clear();
+  }
+  request_render();
+}
+
+void MonitorWindow::request_render() {
+  if (!frameTimer->isActive()) {
+    frameTimer->start();
+  }
+}
+
+void MonitorWindow::render() {
+  // 关闭时只采样，打开时由showEvent重绘
+  if (!isVisible()) {
+    return;
+  }
+
+  const double end = now();
+  const double begin = end - WINDOW_SECONDS;
+  const int columns = std::max(1, static_cast<int>(chart->plotArea().width()));
+
+  double min = std::numeric_limits<double>::max();
+  double max = std::numeric_limits<double>::lowest();
+  QList<QPointF> decimated;
+  auto draw = [&](const Line &line) {
+    decimated.clear();
+    line.samples.decimate(begin, end, columns, [&](double t, double value) {
+      decimated.append(QPointF(t, value));
+      min = std::min(min, value);
+      max = std::max(max, value);
+    });
+    line.series->replace(decimated);
+  };
 
-  const double window_width = 30.0; // 显示最近30秒
+  for (const auto &[name, line] : lines) {
+    if (line.series->isVisible()) {
+      draw(line);
+    }
+  }
+  if (points.samples.size() > 0) {
+    draw(points);
+  }
 
-  axisX->setRange(time_in_seconds - window_width, time_in_seconds);
+  axisX->setRange(begin, end);
+  if (min <= max) {
+    axisY->setRange(std::min(min, 0.0), max > 0 ? max * 1.1 : 1.0);
+  }
 }
 
 MonitorWindow::~MonitorWindow() { delete ui; }
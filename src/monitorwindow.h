@@ -1,11 +1,16 @@
 #ifndef MONITORWINDOW_H
 #define MONITORWINDOW_H
 
+#include "metrics.h"
+#include "timeseries.h"
+#include <QListWidget>
 #include <QMainWindow>
+#include <QTimer>
 #include <QtCharts/QChartView>
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QValueAxis>
 #include <QtWidgets/QMainWindow>
+#include <map>
 #include <qscatterseries.h>
 
 using namespace std::chrono;
@@ -16,6 +21,10 @@ class MonitorWindow;
 }
 QT_END_NAMESPACE
 
+// 按固定频率读取Metrics的快照，每个指标一条曲线，左侧列表勾选要显示的指标。
+// 窗口关闭时也继续采样，打开后可以看到之前的数据。
+// 采样保存在固定容量的TimeSeries中，绘制时按像素列抽取后整体替换曲线的点，
+// 多次更新合并为每帧一次重绘，CPU占用与运行时长无关。
 class MonitorWindow : public QMainWindow {
   Q_OBJECT
 
@@ -25,15 +34,46 @@ public:
   void add_point(qreal time, qreal value);
   void add_point(high_resolution_clock::time_point t_now, qreal value);
 
+protected:
+  void showEvent(QShowEvent *event) override;
+
 private:
+  struct Line {
+    TimeSeries samples{CAPACITY};
+    QXYSeries *series = nullptr;
+  };
+
+  // 取一次快照，把与上次快照之间的值追加到各条曲线
+  void refresh();
+  // 新出现的指标加入列表和图表，默认不显示
+  auto line_of(const QString &name) -> Line &;
+  void show_line(QListWidgetItem *item);
+  // 下一帧重绘，一帧内的多次请求只重绘一次
+  void request_render();
+  // 可见曲线按像素列抽取后替换，横轴跟随当前时间，纵轴适应窗口内的最大值
+  void render();
+  [[nodiscard]] auto now() const -> double;
+
   Ui::MonitorWindow *ui;
   QChart *chart;
   QChartView *chartView;
+  QListWidget *metricList;
   QScatterSeries *series;
   QValueAxis *axisX;
   QValueAxis *axisY;
   high_resolution_clock::time_point start_time;
 
+  QTimer *timer;
+  QTimer *frameTimer;
+  Metrics::Snapshot last;
+  std::map<QString, Line> lines;
+  Line points; // add_point()的采样，显示在series中
+
+  static constexpr int REFRESH_MS = 250;         // 每秒4次
+  static constexpr int FRAME_MS = 16;            // 最多每秒约60次重绘
+  static constexpr double WINDOW_SECONDS = 30.0; // 显示最近30秒
+  static constexpr size_t CAPACITY = 1 << 14;    // 每条曲线保留的采样数
+
 private slots:
 };
 #endif // MONITORWINDOW_H
@@ -17,6 +17,7 @@ void print_whisper_params(const whisper_params &p) {
   PRINT_MEMBER(max_tokens);
   PRINT_MEMBER(audio_ctx);
   PRINT_MEMBER(beam_size);
+  PRINT_MEMBER(stt_workers);
 
   PRINT_MEMBER(n_samples_keep);
   PRINT_MEMBER(n_samples_step);
@@ -40,11 +41,19 @@ void print_whisper_params(const whisper_params &p) {
   PRINT_MEMBER(use_gpu);
   PRINT_MEMBER(flash_attn);
   PRINT_MEMBER(use_vad);
+  PRINT_MEMBER(partial);
+  PRINT_MEMBER(speculative);
+  PRINT_MEMBER(stream);
+  PRINT_MEMBER(no_chat);
 
   PRINT_MEMBER(language);
   PRINT_MEMBER(model);
+  PRINT_MEMBER(trace_out);
 
   PRINT_MEMBER(timeout);
+  PRINT_MEMBER(context_tokens);
+  PRINT_MEMBER(context_strategy);
+  PRINT_MEMBER(chat_connections);
 
   PRINT_MEMBER(llm);
 
@@ -52,6 +61,22 @@ void print_whisper_params(const whisper_params &p) {
   PRINT_MEMBER(init_prompt);
 
   PRINT_MEMBER(vad_model);
+  PRINT_MEMBER(capture_mode);
+  PRINT_MEMBER(audio_backend);
+  for (size_t i = 0; i < p.sources.size(); ++i) {
+    cout << setw(20) << "sources[" + to_string(i) + "]" << setw(10)
+         << p.sources[i] << endl;
+  }
+  for (size_t i = 0; i < p.inputs.size(); ++i) {
+    cout << setw(20) << "inputs[" + to_string(i) + "]" << setw(10)
+         << p.inputs[i] << endl;
+  }
+  for (size_t i = 0; i < p.formats.size(); ++i) {
+    cout << setw(20) << "formats[" + to_string(i) + "]" << setw(10)
+         << p.formats[i] << endl;
+  }
+  PRINT_MEMBER(output_dir);
+  PRINT_MEMBER(in_flight);
 }
 
 auto whisper_params_parse(int argc, char **argv, whisper_params &params)
@@ -101,12 +126,67 @@ auto whisper_params_parse(int argc, char **argv, whisper_params &params)
                "flash attention during inference");
   app.add_flag("--im,--is-microphone", params.is_microphone,
                "select microphone as input");
+  app.add_option("--stt-workers", params.stt_workers,
+                 "number of parallel whisper workers, splitting --threads "
+                 "between them (requires --no-context)")
+      ->check(CLI::PositiveNumber);
   app.add_option("--timeout", params.timeout, "API request timeout(ms)");
+  app.add_option("--context-tokens", params.context_tokens,
+                 "approximate token budget of the history sent to the LLM, "
+                 "0 for unlimited")
+      ->check(CLI::NonNegativeNumber);
+  app.add_option("--context-strategy", params.context_strategy,
+                 "drop the oldest turns beyond the budget, or summarize them")
+      ->check(CLI::IsMember({"window", "summary"}));
+  app.add_option("--chat-connections", params.chat_connections,
+                 "keep-alive connections to --url, summaries use a second "
+                 "one while the reply is generated")
+      ->check(CLI::PositiveNumber);
   app.add_option("--llm", params.llm, "LLM model name.");
   app.add_option("--prompt", params.prompt, "LLM additional prompt");
   app.add_option("--init-prompt", params.init_prompt, "LLM initial prompt");
   app.add_option("--system", params.system, "system role");
   app.add_option("--vad-model", params.vad_model, "vad model path");
+  app.add_option("--capture-mode", params.capture_mode,
+                 "poll audio every 2s or push every VAD window")
+      ->check(CLI::IsMember({"poll", "push"}));
+  app.add_option("--source", params.sources,
+                 "audio source to capture, repeat for several: "
+                 "default_output, mic or an application name, optionally "
+                 "as backend:input, e.g. file:talk.wav@4 or synth:60@0")
+      ->expected(1, -1);
+  app.add_option("--audio-backend", params.audio_backend,
+                 "capture backend: pipewire, sdl, qt, file or synth "
+                 "(default: first available)");
+  app.add_flag("--partial", params.partial,
+               "show partial transcription every --step ms while speaking");
+  app.add_flag("--speculative", params.speculative,
+               "in manual mode, transcribe each sentence as it is queued so "
+               "that sending only waits for unfinished ones");
+  app.add_flag("--stream", params.stream,
+               "stream LLM replies into the preview as they are generated");
+  app.add_flag("--no-chat", params.no_chat,
+               "transcribe only, without sending anything to the LLM");
+  app.add_option("--trace-out", params.trace_out,
+                 "record the latency of each sentence from capture to the "
+                 "LLM reply and write it on exit as a Chrome trace "
+                 "(chrome://tracing or ui.perfetto.dev)");
+  app.add_option("--input", params.inputs,
+                 "speakflow_batch: audio file or directory to transcribe, "
+                 "repeat for several (wav, mp3, flac or ogg)")
+      ->expected(1, -1);
+  app.add_option("--format", params.formats,
+                 "speakflow_batch: subtitle format written for each file, "
+                 "repeat for several")
+      ->expected(1, -1)
+      ->check(CLI::IsMember({"srt", "vtt", "json"}));
+  app.add_option("--output-dir", params.output_dir,
+                 "speakflow_batch: directory for the subtitles (default: "
+                 "next to each input)");
+  app.add_option("--in-flight", params.in_flight,
+                 "speakflow_batch: segments submitted to the whisper workers "
+                 "at once, 0 for 2 per --stt-workers")
+      ->check(CLI::NonNegativeNumber);
 
   CLI11_PARSE(app, argc, argv);
 
@@ -4,6 +4,7 @@
 #include <cstdio>
 #include <string>
 #include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -19,6 +20,7 @@ struct whisper_params {
   int32_t max_tokens = 32;
   int32_t audio_ctx = 0;
   int32_t beam_size = -1;
+  int32_t stt_workers = 1; // whisper states sharing one model
 
   int32_t n_samples_keep = 0;
   int32_t n_samples_step = 0;
@@ -43,14 +45,22 @@ struct whisper_params {
   bool use_gpu = true;
   bool flash_attn = false;
   bool use_vad = false;
+  bool partial = false;     // stream partial hypotheses while speaking
+  bool speculative = false; // transcribe queued sentences before send
+  bool stream = false;      // stream LLM replies as they are generated
+  bool no_chat = false;     // transcribe only, no LLM requests
 
   string language = "en";
   string model = "models/ggml-base.en.bin";
   string fname_out;
+  string trace_out; // Chrome trace of the pipeline stages, written on exit
 
   bool is_print = false;
 
   int32_t timeout = 30000;
+  int32_t context_tokens = 4096;      // LLM history budget, 0: unlimited
+  string context_strategy = "window"; // window or summary
+  int32_t chat_connections = 2;       // keep-alive connections to the LLM
 
   string llm = "gemma3:4b";
 
@@ -59,6 +69,18 @@ struct whisper_params {
   string system = "";
 
   string vad_model = "models/silero_vad.onnx";
+  string capture_mode = "poll"; // poll or push
+  // audio sources captured concurrently, stream id = index;
+  // "backend:input" picks a backend per source
+  vector<string> sources = {"default_output"};
+  string audio_backend = ""; // empty: first available
+
+  // speakflow_batch: audio files or directories, subtitle formats written
+  // for each file, and segments transcribed at once (0: 2 per worker)
+  vector<string> inputs;
+  vector<string> formats = {"srt"};
+  string output_dir = ""; // empty: next to each input
+  int32_t in_flight = 0;
 };
 
 auto whisper_params_parse(int argc, char **argv, whisper_params &params)
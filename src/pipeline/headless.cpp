@@ -0,0 +1,183 @@
+// 不依赖Qt运行完整流程，结果以JSON Lines写到标准输出，日志写到标准错误。
+//
+//   speakflow_headless --source file:talk.wav@0 --model ... [--no-chat]
+//   speakflow_headless --source mic --url http://127.0.0.1:8080/v1 --llm mock
+//
+// 文件等有限的音频源读完后，等待识别和回复全部完成再退出；实时音频源运行
+// 到Ctrl-C，之后同样处理完已采集的音频。每行一个对象，type为：
+//   sentence   检测到的句子：id, stream, seconds(句子时长)
+//   partial    句子进行中的临时识别结果(--partial)：stream, text
+//   transcript 识别结果：id(第一句的编号), stream, text, latency_ms(从采集)
+//   delta      流式回复的增量文本(--stream)：text
+//   response   完整回复：text, latency_ms(从第一句采集)
+//   summary    退出前的统计
+#include "events.h"
+#include "parse.h"
+#include "pipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 停止采集后等待识别和回复完成的最长时间
+constexpr std::chrono::milliseconds DRAIN_TIMEOUT{10 * 60 * 1000};
+
+std::atomic_bool g_running = true;
+
+// 第二次Ctrl-C直接退出
+void on_signal(int signal) {
+  g_running = false;
+  std::signal(signal, SIG_DFL);
+}
+
+// 多个线程发布事件，每行整体写出
+class JsonLines {
+public:
+  void write(nlohmann::json line) {
+    line["t"] = std::chrono::duration<double>(Clock::now() - start).count();
+    const std::string text =
+        line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+  }
+
+private:
+  const Clock::time_point start = Clock::now();
+  std::mutex mutex;
+};
+
+auto since_ms(Clock::time_point captured) -> double {
+  if (captured == Clock::time_point{}) {
+    return 0.0;
+  }
+  return std::chrono::duration<double, std::milli>(Clock::now() - captured)
+      .count();
+}
+
+// "## AI 3 \n回复" 去掉Chat加的标题
+auto strip_title(const std::string &message) -> std::string {
+  const auto end = message.find('\n');
+  return end == std::string::npos ? "" : message.substr(end + 1);
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  whisper_params params;
+  if (!whisper_params_parse(argc, argv, params)) {
+    return 1;
+  }
+
+  // 标准输出只留给结果
+  spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+
+  // 先于pipeline构造，处理函数在pipeline析构前一直可用
+  JsonLines out;
+  std::atomic<uint64_t> n_sentences = 0;
+  std::atomic<uint64_t> n_transcripts = 0;
+  std::atomic<uint64_t> n_responses = 0;
+  std::atomic<double> audio_seconds = 0.0;
+
+  // 回复对应的第一句的采集时间，只在对话线程中使用
+  Trace request;
+  std::string reply;
+
+  Pipeline pipeline(params);
+  if (!pipeline.initialize()) {
+    spdlog::error("sentense initialize failed");
+    return 1;
+  }
+
+  const auto &bus = pipeline.bus();
+  bus->subscribe<AudioAddedEvent>([&](const AudioAddedEvent &audioEvent) {
+    n_sentences++;
+    audio_seconds.fetch_add(audioEvent.audio.duration().count());
+    out.write({{"type", "sentence"},
+               {"id", audioEvent.id},
+               {"stream", audioEvent.stream_id},
+               {"seconds", audioEvent.audio.duration().count()}});
+  });
+  bus->subscribe<MessagePartialEvent>(
+      [&](const MessagePartialEvent &partialEvent) {
+        if (!partialEvent.message.empty()) {
+          out.write({{"type", "partial"},
+                     {"stream", partialEvent.stream_id},
+                     {"text", partialEvent.message}});
+        }
+      });
+  bus->subscribe<MessageAddedEvent>([&](const MessageAddedEvent &message) {
+    if (message.serviceName == "stt") {
+      n_transcripts++;
+      out.write({{"type", "transcript"},
+                 {"id", message.trace.id},
+                 {"stream", message.stream_id},
+                 {"text", message.message},
+                 {"latency_ms", since_ms(message.trace.captured)}});
+    } else if (message.serviceName == "chat") {
+      if (message.message.starts_with("## USER")) {
+        request = message.trace;
+      } else if (message.message.starts_with("## AI")) {
+        n_responses++;
+        out.write({{"type", "response"},
+                   {"text", strip_title(message.message)},
+                   {"latency_ms", since_ms(request.captured)}});
+      }
+    }
+  });
+  bus->subscribe<MessageDeltaEvent>([&](const MessageDeltaEvent &delta) {
+    if (delta.serviceName != "chat") {
+      return;
+    }
+    if (delta.delta.starts_with("## AI")) {
+      reply.clear();
+    } else if (delta.done) {
+      n_responses++;
+      out.write({{"type", "response"},
+                 {"text", reply},
+                 {"latency_ms", since_ms(request.captured)}});
+    } else {
+      reply += delta.delta;
+      out.write({{"type", "delta"}, {"text", delta.delta}});
+    }
+  });
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+
+  const auto started = Clock::now();
+  pipeline.start(true);
+  while (g_running && !pipeline.capture_finished()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  const bool drained = pipeline.drain(DRAIN_TIMEOUT);
+  if (!drained) {
+    spdlog::warn("pipeline not drained after {} s, stopping",
+                 DRAIN_TIMEOUT.count() / 1000);
+  }
+  pipeline.stop();
+
+  const double elapsed =
+      std::chrono::duration<double>(Clock::now() - started).count();
+  out.write({{"type", "summary"},
+             {"sentences", n_sentences.load()},
+             {"transcripts", n_transcripts.load()},
+             {"responses", n_responses.load()},
+             {"audio_seconds", audio_seconds.load()},
+             {"elapsed_seconds", elapsed},
+             {"drained", drained}});
+  return drained ? 0 : 1;
+}
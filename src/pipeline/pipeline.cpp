@@ -0,0 +1,146 @@
+#include "pipeline.h"
+#include "events.h"
+#include "trace.h"
+
+#include <spdlog/spdlog.h>
+#include <thread>
+
+Pipeline::Pipeline(const whisper_params &params)
+    : params(params), cparams(whisper_context_default_params()),
+      wparams(whisper_full_default_params(params.beam_size > 1
+                                              ? WHISPER_SAMPLING_BEAM_SEARCH
+                                              : WHISPER_SAMPLING_GREEDY)),
+      eventBus(std::make_shared<EventBus>()),
+      sentense(params.vad_model, eventBus, WHISPER_SAMPLE_RATE,
+               params.capture_mode == "push" ? Sentense::CaptureMode::Push
+                                             : Sentense::CaptureMode::Poll,
+               params.sources, params.audio_backend) {
+  // 在任何服务启动前开启，之后各阶段才会记录
+  if (!params.trace_out.empty()) {
+    Tracer::instance().enable();
+  }
+
+  // whisper init
+  if (params.language != "auto" &&
+      whisper_lang_id(params.language.c_str()) == -1) {
+    spdlog::error("error: unknown language '{}'", params.language);
+    // whisper_print_usage(argc, argv, params);
+    exit(0);
+  }
+
+  spdlog::info("pipeline params.language is: {}", params.language);
+  set_params();
+  STTPartialParams partial;
+  if (params.partial) {
+    partial.step_samples = params.n_samples_step;
+    partial.length_samples = params.n_samples_len;
+    partial.keep_samples = params.n_samples_keep;
+  }
+  stt = make_unique<STT>(cparams, wparams, params.model, params.language,
+                         params.no_context, eventBus, partial,
+                         params.stt_workers);
+  stt->setSpeculative(params.speculative);
+  sentense.setPartialEnabled(params.partial);
+
+  if (!params.no_chat) {
+    chat = make_unique<Chat>(
+        params.url, params.token, params.llm, params.timeout, params.system,
+        eventBus, params.stream, params.context_tokens,
+        params.context_strategy == "summary" ? ChatContext::Strategy::Summary
+                                             : ChatContext::Strategy::Window,
+        params.chat_connections);
+  }
+
+  // 采集也可能由界面启动，停止时需要知道
+  eventBus->subscribe<StartServiceEvent>(
+      [this](const StartServiceEvent &startEvent) {
+        if (startEvent.serviceName == "sentense") {
+          capturing = true;
+        }
+      });
+}
+
+Pipeline::~Pipeline() { stop(); }
+
+auto Pipeline::initialize() -> bool { return sentense.initialize(); }
+
+void Pipeline::start(bool capture) {
+  started = true;
+  eventBus->publish<StartServiceEvent>("stt");
+  if (chat) {
+    eventBus->publish<StartServiceEvent>("chat");
+    if (params.init_prompt != "") {
+      eventBus->publish<MessageAddedEvent>("stt", params.init_prompt);
+    }
+  }
+  if (capture) {
+    // 没有界面点击发送，句子识别完立即发送
+    eventBus->publish<AutoModeSetEvent>("stt", true);
+    eventBus->publish<StartServiceEvent>("sentense");
+  }
+}
+
+auto Pipeline::drain(std::chrono::milliseconds timeout) -> bool {
+  // 停止时处理完剩余的音频，并结束未完成的句子
+  if (capturing.exchange(false)) {
+    eventBus->publish<StopServiceEvent>("sentense");
+  }
+
+  // 句子交给下一阶段之后才不再计数，先检查上游再检查下游，一次空闲即完成
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!stt->idle() || (chat && !chat->idle())) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return true;
+}
+
+void Pipeline::stop() {
+  // 初始化失败时服务没有启动，它们的线程不能join
+  if (!started || stopped) {
+    return;
+  }
+  stopped = true;
+
+  if (capturing.exchange(false)) {
+    eventBus->publish<StopServiceEvent>("sentense");
+  }
+  eventBus->publish<StopServiceEvent>("stt");
+  if (chat) {
+    eventBus->publish<StopServiceEvent>("chat");
+  }
+
+  // 服务都已停止，不会再有新的记录
+  if (!params.trace_out.empty()) {
+    if (Tracer::instance().write_chrome_trace(params.trace_out)) {
+      spdlog::info("trace written to {}", params.trace_out);
+    } else {
+      spdlog::error("cannot write trace to {}", params.trace_out);
+    }
+  }
+}
+
+void Pipeline::set_params() {
+  cparams.use_gpu = params.use_gpu;
+  cparams.flash_attn = params.flash_attn;
+
+  wparams.print_progress = false;
+  wparams.print_special = params.print_special;
+  wparams.print_realtime = false;
+  wparams.print_timestamps = !params.no_timestamps;
+  wparams.translate = params.translate;
+  wparams.single_segment = !params.use_vad;
+  wparams.max_tokens = params.max_tokens;
+  wparams.n_threads = params.n_threads;
+  wparams.beam_search.beam_size = params.beam_size;
+
+  wparams.audio_ctx = params.audio_ctx;
+
+  wparams.tdrz_enable = params.tinydiarize; // [TDRZ]
+
+  // disable temperature fallback
+  // wparams.temperature_inc  = -1.0f;
+  wparams.temperature_inc = params.no_fallback ? 0.0f : wparams.temperature_inc;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "chat.h"
+#include "eventbus.h"
+#include "parse.h"
+#include "sentense.h"
+#include "stt.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <whisper.h>
+
+// 按命令行参数搭建 采集→VAD→语音识别→AI对话 的完整流程，不依赖Qt。
+// 图形界面和无界面运行(speakflow_headless)共用，模块之间只通过事件总线通信。
+class Pipeline {
+public:
+  explicit Pipeline(const whisper_params &params);
+  ~Pipeline();
+
+  Pipeline(const Pipeline &) = delete;
+  auto operator=(const Pipeline &) -> Pipeline & = delete;
+
+  // 初始化音频采集，失败时返回false
+  auto initialize() -> bool;
+  // 启动语音识别和AI对话。capture为true时同时开始采集，句子自动发送；
+  // 图形界面中采集由CardMan的按钮控制
+  void start(bool capture = false);
+  // 停止采集并处理完已采集的音频，等待识别和回复全部完成，超时返回false
+  auto drain(std::chrono::milliseconds timeout) -> bool;
+  // 停止全部服务，开启跟踪时导出；可以重复调用，没有start()时什么都不做
+  void stop();
+
+  [[nodiscard]] auto bus() const -> const std::shared_ptr<EventBus> & {
+    return eventBus;
+  }
+  // 文件等有限的音频源已全部读完
+  [[nodiscard]] auto capture_finished() const -> bool {
+    return sentense.finished();
+  }
+
+private:
+  void set_params();
+
+  whisper_params params;
+  whisper_context_params cparams;
+  whisper_full_params wparams;
+
+  std::shared_ptr<EventBus> eventBus;
+  Sentense sentense;
+  unique_ptr<STT> stt;
+  unique_ptr<Chat> chat; // --no-chat时为空
+
+  std::atomic_bool capturing = false;
+  bool started = false;
+  bool stopped = false;
+};
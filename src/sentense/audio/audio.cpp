@@ -0,0 +1,116 @@
+#include "audio.h"
+#include "fileaudio.h"
+#include "synthaudio.h"
+#include <algorithm>
+
+#ifdef USE_PIPEWIRE_AUDIO
+#include "pipeaudio.h"
+#endif
+#ifdef USE_SDL_AUDIO
+#include "sdlaudio.h"
+#endif
+#ifdef USE_QT_AUDIO
+#include "qtaudio.h"
+#endif
+
+namespace {
+
+template <typename T> auto make(int len_ms) -> std::unique_ptr<AsyncAudio> {
+  return std::make_unique<T>(len_ms);
+}
+
+struct Backend {
+  const char *name;
+  std::unique_ptr<AsyncAudio> (*create)(int len_ms);
+};
+
+// Device backends first, in order of preference.
+const Backend registry[] = {
+#ifdef USE_PIPEWIRE_AUDIO
+    {"pipewire", make<PipeWireAudio>},
+#endif
+#ifdef USE_SDL_AUDIO
+    {"sdl", make<SDLAudio>},
+#endif
+#ifdef USE_QT_AUDIO
+    {"qt", make<QTAudio>},
+#endif
+    {"file", make<FileAudio>},
+    {"synth", make<SynthAudio>},
+};
+
+} // namespace
+
+auto AsyncAudio::create(const std::string &type, int len_ms)
+    -> std::unique_ptr<AsyncAudio> {
+  for (const auto &backend : registry) {
+    if (type == backend.name) {
+      return backend.create(len_ms);
+    }
+  }
+  return nullptr;
+}
+
+auto AsyncAudio::backends() -> std::vector<std::string> {
+  std::vector<std::string> names;
+  for (const auto &backend : registry) {
+    names.emplace_back(backend.name);
+  }
+  return names;
+}
+
+auto AsyncAudio::default_backend() -> std::string {
+  // file and synth only run when asked for by name
+  const std::string first = registry[0].name;
+  return first == "file" ? "" : first;
+}
+
+auto AsyncAudio::split_source(const std::string &spec)
+    -> std::pair<std::string, std::string> {
+  auto colon = spec.find(':');
+  if (colon == std::string::npos) {
+    // a bare backend name selects it with its default input
+    for (const auto &backend : registry) {
+      if (spec == backend.name) {
+        return {spec, ""};
+      }
+    }
+  } else {
+    std::string name = spec.substr(0, colon);
+    for (const auto &backend : registry) {
+      if (name == backend.name) {
+        return {name, spec.substr(colon + 1)};
+      }
+    }
+  }
+  return {"", spec};
+}
+
+void AsyncAudio::init_ring(int sample_rate) {
+  sample_rate_ = sample_rate;
+  ring_.reset(static_cast<size_t>(sample_rate) * max_buffer_len_ms_ / 1000);
+}
+
+void AsyncAudio::get(int ms, std::vector<float> &audio) {
+  if (ms <= 0) {
+    ms = max_buffer_len_ms_;
+  }
+
+  auto view = ring_.read_spans();
+  const size_t n_samples =
+      std::min(view.size(), static_cast<size_t>(sample_rate_) * ms / 1000);
+
+  audio.resize(n_samples);
+  view.subview(view.size() - n_samples, n_samples).copy_to(audio.data());
+
+  ring_.advance(view.size());
+}
+
+void AsyncAudio::read(std::vector<float> &audio) {
+  auto view = ring_.read_spans();
+
+  audio.resize(view.size());
+  view.copy_to(audio.data());
+
+  ring_.advance(audio.size());
+}
@@ -1,6 +1,12 @@
 #pragma once
+#include "ringbuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <semaphore>
 #include <string>
+#include <utility>
 #include <vector>
 
 class AsyncAudio {
@@ -19,15 +25,91 @@ public:
   virtual auto resume() -> bool = 0;
   virtual auto pause() -> bool = 0;
   virtual auto clear() -> bool = 0;
-  virtual void get(int ms, std::vector<float> &audio) = 0;
 
+  // get the last ms of captured audio, older unread audio is discarded
+  virtual void get(int ms, std::vector<float> &audio);
+
+  // get all audio captured since the previous read()
+  virtual void read(std::vector<float> &audio);
+
+  // Zero-copy read: view of all captured audio not consumed yet. The view
+  // stays valid, and keeps growing on later calls, until consume() releases
+  // its oldest samples back to the capture callback.
+  auto peek() -> RingView<float> { return ring_.read_spans(); }
+  void consume(size_t n_samples) { ring_.advance(n_samples); }
+
+  // true once a finite source (file, timed synth) has delivered all audio
+  [[nodiscard]] virtual auto finished() const -> bool { return false; }
+
+  // samples lost because the consumer fell behind by a whole buffer
+  [[nodiscard]] auto dropped() const -> uint64_t { return ring_.dropped(); }
+
+  // Push mode: wake up a consumer blocked in wait_for_data() every time
+  // another ms worth of audio has been captured (0 disables notification).
+  void set_notify_ms(int ms) { notify_ms_ = ms; }
+
+  // returns false on timeout
+  auto wait_for_data(int timeout_ms) -> bool {
+    if (!data_ready_.try_acquire_for(std::chrono::milliseconds(timeout_ms))) {
+      return false;
+    }
+    signaled_ = false;
+    return true;
+  }
+
+  // Backend registry: every backend compiled into audio_backend can be
+  // created by name at runtime. Returns nullptr for unknown names.
   static auto create(const std::string &type, int len_ms = 2000)
       -> std::unique_ptr<AsyncAudio>;
 
+  // registered backend names, device backends first
+  static auto backends() -> std::vector<std::string>;
+
+  // first device backend compiled in, or "" if there is none
+  static auto default_backend() -> std::string;
+
+  // "backend:input" -> {backend, input}, a bare backend name -> {backend,
+  // ""}. A spec without a registered backend prefix returns {"", spec}.
+  static auto split_source(const std::string &spec)
+      -> std::pair<std::string, std::string>;
+
 protected:
+  // size the capture ring for max_buffer_len_ms_, call from init()
+  void init_ring(int sample_rate);
+
+  // capture side: store samples without locking or allocating
+  void push_samples(const float *samples, size_t n_samples) {
+    ring_.write(samples, n_samples);
+    on_captured(n_samples);
+  }
+
+  // called by the capture callback after storing n_samples new samples
+  void on_captured(size_t n_samples) {
+    if (notify_ms_ <= 0) {
+      return;
+    }
+    pending_samples_ += n_samples;
+    if (pending_samples_ * 1000 >= static_cast<size_t>(sample_rate_) *
+                                       static_cast<size_t>(notify_ms_)) {
+      pending_samples_ = 0;
+      if (!signaled_.exchange(true)) {
+        data_ready_.release();
+      }
+    }
+  }
+
   int sample_rate_ = 16000;
   InputType input_type_ = InputType::DefaultMicrophone;
   bool is_initialized_ = false;
   bool is_paused_ = false;
   const int max_buffer_len_ms_;
+
+  // written only by the capture callback, read only by the consumer
+  SpscRingBuffer<float> ring_;
+
+private:
+  std::atomic<int> notify_ms_ = 0;
+  size_t pending_samples_ = 0; // only touched by the capture thread
+  std::atomic_bool signaled_ = false;
+  std::binary_semaphore data_ready_{0};
 };
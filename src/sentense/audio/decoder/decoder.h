@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Decodes an audio file (WAV, MP3, FLAC or Vorbis, through miniaudio and
+// stb_vorbis) to 32-bit float PCM, converted to the given sample rate and
+// channel count. Channels are interleaved. fname "-" reads from stdin, and
+// fname can also be a buffer of WAV data instead of a filename.
+auto decode_audio(const string &fname, int sample_rate, int channels,
+                  vector<float> &pcm) -> bool;
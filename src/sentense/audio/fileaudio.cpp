@@ -0,0 +1,23 @@
+#include "fileaudio.h"
+#include "decoder.h"
+#include <algorithm>
+#include <iostream>
+
+// miniaudio decodes and resamples with a low-pass filter, downmixing to mono
+auto FileAudio::open(int sample_rate, const std::string &input) -> bool {
+  if (!decode_audio(input, sample_rate, 1, samples_)) {
+    return false;
+  }
+
+  pos_ = 0;
+  std::cerr << "file audio: " << input << ", "
+            << samples_.size() / sample_rate << " s" << std::endl;
+  return true;
+}
+
+auto FileAudio::generate(float *out, size_t n) -> size_t {
+  n = std::min(n, samples_.size() - pos_);
+  std::copy_n(samples_.data() + pos_, n, out);
+  pos_ += n;
+  return n;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "pacedaudio.h"
+#include <string>
+#include <vector>
+
+//
+// Replays an audio file (WAV, MP3, FLAC or Vorbis, any sample rate and
+// channel count) as if it were being captured. Input: "<path>[@speed]".
+//
+class FileAudio : public PacedAudio {
+public:
+  explicit FileAudio(int len_ms = 2000) : PacedAudio(len_ms) {}
+  ~FileAudio() override { shutdown(); }
+
+protected:
+  auto open(int sample_rate, const std::string &input) -> bool override;
+  auto generate(float *out, size_t n) -> size_t override;
+
+private:
+  std::vector<float> samples_;
+  size_t pos_ = 0;
+};
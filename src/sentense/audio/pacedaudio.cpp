@@ -0,0 +1,121 @@
+#include "pacedaudio.h"
+#include <chrono>
+#include <iostream>
+
+PacedAudio::~PacedAudio() { shutdown(); }
+
+void PacedAudio::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+auto PacedAudio::init(int sample_rate, const std::string &input) -> bool {
+  if (is_initialized_) {
+    return true;
+  }
+
+  std::string source = input;
+  if (auto at = input.rfind('@'); at != std::string::npos) {
+    try {
+      speed_ = std::stod(input.substr(at + 1));
+    } catch (const std::exception &) {
+      std::cerr << "invalid speed in audio input: " << input << std::endl;
+      return false;
+    }
+    source = input.substr(0, at);
+  }
+  if (speed_ < 0) {
+    speed_ = 1.0;
+  }
+
+  if (!open(sample_rate, source)) {
+    return false;
+  }
+
+  init_ring(sample_rate);
+  block_.resize(sample_rate / 100); // 10 ms per write
+  is_initialized_ = true;
+  thread_ = std::thread(&PacedAudio::run, this);
+  return true;
+}
+
+auto PacedAudio::resume() -> bool {
+  if (!is_initialized_) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+  }
+  cv_.notify_all();
+  return true;
+}
+
+auto PacedAudio::pause() -> bool {
+  if (!is_initialized_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  running_ = false;
+  return true;
+}
+
+auto PacedAudio::clear() -> bool {
+  ring_.clear();
+  return true;
+}
+
+void PacedAudio::run() {
+  using clock = std::chrono::steady_clock;
+
+  // pacing restarts from here after every pause
+  auto t0 = clock::now();
+  size_t produced = 0;
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!running_) {
+        cv_.wait(lock, [this]() { return running_ || quit_; });
+        t0 = clock::now();
+        produced = 0;
+      }
+      if (quit_) {
+        return;
+      }
+    }
+
+    if (speed_ == 0) {
+      // flow control: wait for the consumer instead of dropping
+      auto [first, second] = ring_.write_spans();
+      if (first.size() + second.size() < block_.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+    } else {
+      const auto due =
+          t0 + std::chrono::duration_cast<clock::duration>(
+                   std::chrono::duration<double>(
+                       produced / (sample_rate_ * speed_)));
+      std::this_thread::sleep_until(due);
+    }
+
+    const size_t n = generate(block_.data(), block_.size());
+    if (n == 0) {
+      finished_ = true;
+      // no more audio: wake a push-mode consumer for the tail
+      on_captured(static_cast<size_t>(sample_rate_));
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return quit_; });
+      return;
+    }
+    push_samples(block_.data(), n);
+    produced += n;
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "audio.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Base for sources that generate audio in software instead of capturing
+// it from a device. A producer thread feeds the capture ring at speed times
+// real time; speed 0 means as fast as the consumer frees ring space, which
+// never drops samples and suits deterministic benchmarks.
+//
+// Input specs end with an optional "@<speed>" suffix, e.g. "talk.wav@4".
+//
+class PacedAudio : public AsyncAudio {
+public:
+  explicit PacedAudio(int len_ms = 2000) : AsyncAudio(len_ms) {}
+  ~PacedAudio() override;
+
+  auto init(int sample_rate, const std::string &input) -> bool override;
+  auto resume() -> bool override;
+  auto pause() -> bool override;
+  auto clear() -> bool override;
+
+  [[nodiscard]] auto finished() const -> bool override { return finished_; }
+
+protected:
+  // Opens the source described by input (speed suffix removed).
+  virtual auto open(int sample_rate, const std::string &input) -> bool = 0;
+
+  // Writes up to n samples, returns how many; 0 ends the stream.
+  virtual auto generate(float *out, size_t n) -> size_t = 0;
+
+  // Stops the producer thread. Subclasses call it from their destructor,
+  // before the state generate() reads is destroyed.
+  void shutdown();
+
+private:
+  void run();
+
+  double speed_ = 1.0;
+  std::vector<float> block_;
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool running_ = false; // guarded by mutex_
+  bool quit_ = false;    // guarded by mutex_
+  std::atomic_bool finished_ = false;
+};
@@ -22,7 +22,7 @@ auto PipeWireAudio::init(int sample_rate, const std::string &input) -> bool {
   if (is_initialized_) {
     return true;
   }
-  std::cout << "input string: " << input << std::endl;
+  std::cerr << "input string: " << input << std::endl;
 
   sample_rate_ = sample_rate;
   if (!input.empty()) {
@@ -34,6 +34,9 @@ auto PipeWireAudio::init(int sample_rate, const std::string &input) -> bool {
     target_ = input;
   }
 
+  // allocate the capture ring before the realtime callback can run
+  init_ring(sample_rate_);
+
   pw_init(nullptr, nullptr);
   loop_ = pw_main_loop_new(nullptr);
   if (!loop_) {
@@ -81,7 +84,6 @@ auto PipeWireAudio::init(int sample_rate, const std::string &input) -> bool {
     return false;
   }
 
-  buffer_.reserve(sample_rate_ * max_buffer_len_ms_ / 1000);
   is_initialized_ = true;
   is_paused_ = false;
 
@@ -107,34 +109,10 @@ auto PipeWireAudio::pause() -> bool {
 }
 
 auto PipeWireAudio::clear() -> bool {
-  std::lock_guard<std::mutex> lock(buffer_mutex_);
-  buffer_.clear();
+  ring_.clear();
   return true;
 }
 
-void PipeWireAudio::get(int ms, std::vector<float> &audio) {
-  if (!is_initialized_ || is_paused_) {
-    audio.clear();
-    return;
-  }
-
-  size_t samples_needed = sample_rate_ * ms / 1000;
-  std::unique_lock<std::mutex> lock(buffer_mutex_);
-
-  if (buffer_.size() < samples_needed) {
-    buffer_cv_.wait_for(
-        lock, std::chrono::milliseconds(100),
-        [this, samples_needed] { return buffer_.size() >= samples_needed; });
-  }
-
-  if (buffer_.size() >= samples_needed) {
-    auto start = buffer_.end() - samples_needed;
-    audio.assign(start, buffer_.end());
-  } else {
-    audio.assign(buffer_.begin(), buffer_.end());
-  }
-}
-
 void PipeWireAudio::cleanup() {
   if (loop_) {
     pw_main_loop_quit(loop_);
@@ -178,20 +156,8 @@ void PipeWireAudio::on_process(void *userdata) {
 
   uint32_t n_samples = buf->datas[0].chunk->size / sizeof(float);
 
-  {
-    std::lock_guard<std::mutex> lock(self->buffer_mutex_);
-    size_t max_samples = self->sample_rate_ * self->max_buffer_len_ms_ / 1000;
-
-    self->buffer_.insert(self->buffer_.end(), samples, samples + n_samples);
-
-    if (self->buffer_.size() > max_samples) {
-      self->buffer_.erase(self->buffer_.begin(),
-                          self->buffer_.begin() +
-                              (self->buffer_.size() - max_samples));
-    }
-  }
-
-  self->buffer_cv_.notify_one();
+  // realtime thread: wait-free copy into the capture ring
+  self->push_samples(samples, n_samples);
   pw_stream_queue_buffer(self->stream_, b);
 }
 
@@ -216,11 +182,3 @@ void PipeWireAudio::on_stream_param_changed(void *userdata, uint32_t id,
   spa_format_audio_raw_parse(param, &info.info.raw);
   self->sample_rate_ = info.info.raw.rate;
 }
-
-auto AsyncAudio::create(const std::string &type, int len_ms)
-    -> std::unique_ptr<AsyncAudio> {
-  if (type == "pipewire") {
-    return std::make_unique<PipeWireAudio>(len_ms);
-  }
-  return nullptr;
-}
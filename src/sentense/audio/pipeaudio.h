@@ -1,10 +1,7 @@
 #include "audio.h"
-#include <condition_variable>
-#include <mutex>
 #include <pipewire/pipewire.h>
 #include <spa/param/audio/format-utils.h>
 #include <thread>
-#include <vector>
 
 class PipeWireAudio : public AsyncAudio {
 public:
@@ -15,7 +12,6 @@ public:
   auto resume() -> bool override;
   auto pause() -> bool override;
   auto clear() -> bool override;
-  void get(int ms, std::vector<float> &audio) override;
 
 private:
   void cleanup();
@@ -27,9 +23,6 @@ private:
   struct pw_main_loop *loop_ = nullptr;
   struct pw_stream *stream_ = nullptr;
   std::thread thread_;
-  std::vector<float> buffer_;
-  std::mutex buffer_mutex_;
-  std::condition_variable buffer_cv_;
   std::string target_;
 
   static const struct pw_stream_events stream_events_;
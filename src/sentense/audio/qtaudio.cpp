@@ -1,8 +1,9 @@
 #include "qtaudio.h"
+#include <algorithm>
 
 // Implementation
 QTAudio::QTAudio(int len_ms, QObject *parent)
-    : QObject(parent), m_len_ms(len_ms) {}
+    : QObject(parent), AsyncAudio(len_ms) {}
 
 QTAudio::~QTAudio() {
   if (m_audioSource) {
@@ -49,8 +50,7 @@ auto QTAudio::init(int sample_rate, const std::string &input) -> bool {
     format = m_device.preferredFormat();
   }
 
-  m_sample_rate = format.sampleRate();
-  m_audio.resize((m_sample_rate * m_len_ms) / 1000);
+  init_ring(format.sampleRate());
 
   m_audioSource = new QAudioSource(m_device, format, this);
   connect(m_audioSource, &QAudioSource::stateChanged, this,
@@ -105,9 +105,7 @@ auto QTAudio::clear() -> bool {
     return false;
   }
 
-  QMutexLocker locker(&m_mutex);
-  m_audio_pos = 0;
-  m_audio_len = 0;
+  ring_.clear();
   return true;
 }
 
@@ -137,75 +135,22 @@ void QTAudio::readAudioData() {
   const qint64 bytesAvailable = m_audioIO->bytesAvailable();
   const size_t n_samples = bytesAvailable / sizeof(float);
 
-  if (n_samples > m_audio.size()) {
-    m_audioIO->read(reinterpret_cast<char *>(m_audio.data()),
-                    m_audio.size() * sizeof(float));
-    return;
-  }
-
-  QMutexLocker locker(&m_mutex);
-
-  if (m_audio_pos + n_samples > m_audio.size()) {
-    const size_t n0 = m_audio.size() - m_audio_pos;
-    m_audioIO->read(reinterpret_cast<char *>(&m_audio[m_audio_pos]),
-                    n0 * sizeof(float));
-    m_audioIO->read(reinterpret_cast<char *>(&m_audio[0]),
-                    (n_samples - n0) * sizeof(float));
-  } else {
-    m_audioIO->read(reinterpret_cast<char *>(&m_audio[m_audio_pos]),
-                    n_samples * sizeof(float));
-  }
-
-  m_audio_pos = (m_audio_pos + n_samples) % m_audio.size();
-  m_audio_len = std::min(m_audio_len + n_samples, m_audio.size());
-}
+  // read straight into the free part of the capture ring
+  auto [first, second] = ring_.write_spans();
+  const size_t n0 = std::min(n_samples, first.size());
+  const size_t n1 = std::min(n_samples - n0, second.size());
 
-void QTAudio::get(int ms, std::vector<float> &result) {
-  if (!m_audioSource) {
-    qDebug() << "No audio device to get audio from!";
-    return;
+  m_audioIO->read(reinterpret_cast<char *>(first.data()), n0 * sizeof(float));
+  if (n1 > 0) {
+    m_audioIO->read(reinterpret_cast<char *>(second.data()),
+                    n1 * sizeof(float));
   }
+  ring_.commit_write(n0 + n1);
 
-  if (!m_running) {
-    qDebug() << "Not running!";
-    return;
+  if (n0 + n1 < n_samples) {
+    // consumer fell behind, drop what does not fit
+    m_audioIO->skip((n_samples - n0 - n1) * sizeof(float));
   }
 
-  result.clear();
-
-  QMutexLocker locker(&m_mutex);
-
-  if (ms <= 0) {
-    ms = m_len_ms;
-  }
-
-  size_t n_samples = (m_sample_rate * ms) / 1000;
-  if (n_samples > m_audio_len) {
-    n_samples = m_audio_len;
-  }
-
-  result.resize(n_samples);
-
-  int s0 = m_audio_pos - n_samples;
-  if (s0 < 0) {
-    s0 += m_audio.size();
-  }
-
-  if (s0 + n_samples > m_audio.size()) {
-    const size_t n0 = m_audio.size() - s0;
-    std::copy(m_audio.begin() + s0, m_audio.end(), result.begin());
-    std::copy(m_audio.begin(), m_audio.begin() + (n_samples - n0),
-              result.begin() + n0);
-  } else {
-    std::copy(m_audio.begin() + s0, m_audio.begin() + s0 + n_samples,
-              result.begin());
-  }
-}
-
-auto AsyncAudio::create(const std::string &type, int len_ms)
-    -> std::unique_ptr<AsyncAudio> {
-  if (type == "qt") {
-    return std::make_unique<QTAudio>(len_ms);
-  }
-  return nullptr;
+  on_captured(n0 + n1);
 }
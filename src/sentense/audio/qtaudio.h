@@ -3,7 +3,6 @@
 #include <QAudioSource>
 #include <QDebug>
 #include <QMediaDevices>
-#include <QMutex>
 #include <QThread>
 #include <vector>
 
@@ -17,7 +16,6 @@ public:
   auto resume() -> bool override;
   auto pause() -> bool override;
   auto clear() -> bool override;
-  void get(int ms, std::vector<float> &result) override;
 
 private slots:
   void handleStateChanged(QAudio::State newState);
@@ -28,13 +26,5 @@ private:
   QAudioSource *m_audioSource = nullptr;
   QIODevice *m_audioIO = nullptr;
 
-  int m_len_ms;
-  int m_sample_rate = 0;
   bool m_running = false;
-
-  std::vector<float> m_audio;
-  size_t m_audio_pos = 0;
-  size_t m_audio_len = 0;
-
-  QMutex m_mutex;
 };
@@ -0,0 +1,158 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Read-only view of ring contents, split into two spans on wraparound.
+template <typename T> struct RingView {
+  std::span<const T> first;
+  std::span<const T> second;
+
+  [[nodiscard]] auto size() const -> size_t {
+    return first.size() + second.size();
+  }
+  [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+  // count samples starting at offset, clamped to the view
+  [[nodiscard]] auto subview(size_t offset, size_t count) const -> RingView {
+    offset = std::min(offset, size());
+    count = std::min(count, size() - offset);
+    if (offset >= first.size()) {
+      return {second.subspan(offset - first.size(), count), {}};
+    }
+    const size_t n0 = std::min(count, first.size() - offset);
+    return {first.subspan(offset, n0), second.first(count - n0)};
+  }
+
+  // copies the view to out, returns the end of the written range
+  auto copy_to(T *out) const -> T * {
+    out = std::copy(first.begin(), first.end(), out);
+    return std::copy(second.begin(), second.end(), out);
+  }
+};
+
+// Wait-free single-producer/single-consumer ring buffer.
+//
+// The capacity is rounded up to a power of two so positions wrap with a
+// mask. Read and write positions grow monotonically and live on separate
+// cache lines. The producer never locks or allocates: samples that do not
+// fit are dropped and counted in dropped().
+template <typename T> class SpscRingBuffer {
+public:
+  using Spans = std::pair<std::span<T>, std::span<T>>;
+
+  explicit SpscRingBuffer(size_t capacity = 0) { reset(capacity); }
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  auto operator=(const SpscRingBuffer &) -> SpscRingBuffer & = delete;
+
+  // Not thread safe: call before the producer and consumer start.
+  void reset(size_t capacity) {
+    capacity = capacity > 0 ? std::bit_ceil(capacity) : 0;
+    buffer_.assign(capacity, T{});
+    mask_ = capacity > 0 ? capacity - 1 : 0;
+    write_pos_.store(0, std::memory_order_relaxed);
+    read_pos_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    cached_read_pos_ = 0;
+  }
+
+  [[nodiscard]] auto capacity() const -> size_t { return buffer_.size(); }
+
+  // ---- producer side ----
+
+  // Free space as up to two spans, in write order.
+  auto write_spans() -> Spans {
+    const size_t w = write_pos_.load(std::memory_order_relaxed);
+    cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    return split(w, buffer_.size() - (w - cached_read_pos_));
+  }
+
+  // Publishes n samples written into write_spans().
+  void commit_write(size_t n) {
+    write_pos_.store(write_pos_.load(std::memory_order_relaxed) + n,
+                     std::memory_order_release);
+  }
+
+  // Copies as many samples as fit, returns the number written.
+  auto write(const T *data, size_t n) -> size_t {
+    if (buffer_.empty()) {
+      return 0;
+    }
+    const size_t w = write_pos_.load(std::memory_order_relaxed);
+    if (buffer_.size() - (w - cached_read_pos_) < n) {
+      cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    }
+    const size_t free = buffer_.size() - (w - cached_read_pos_);
+    const size_t count = std::min(n, free);
+
+    auto [first, second] = split(w, count);
+    std::copy(data, data + first.size(), first.begin());
+    std::copy(data + first.size(), data + count, second.begin());
+
+    write_pos_.store(w + count, std::memory_order_release);
+    if (count < n) {
+      dropped_.fetch_add(n - count, std::memory_order_relaxed);
+    }
+    return count;
+  }
+
+  // ---- consumer side ----
+
+  [[nodiscard]] auto size() const -> size_t {
+    return write_pos_.load(std::memory_order_acquire) -
+           read_pos_.load(std::memory_order_relaxed);
+  }
+
+  // Readable samples as up to two contiguous spans, oldest first. The view
+  // stays valid until advance() releases it.
+  auto read_spans() -> RingView<T> {
+    const size_t r = read_pos_.load(std::memory_order_relaxed);
+    auto [first, second] =
+        split(r, write_pos_.load(std::memory_order_acquire) - r);
+    return {first, second};
+  }
+
+  // Releases the n oldest samples back to the producer.
+  void advance(size_t n) {
+    read_pos_.store(read_pos_.load(std::memory_order_relaxed) + n,
+                    std::memory_order_release);
+  }
+
+  // Drops everything readable; consumer side, safe while capturing.
+  void clear() { advance(size()); }
+
+  // Samples the producer had to drop because the ring was full.
+  [[nodiscard]] auto dropped() const -> uint64_t {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+private:
+  auto split(size_t pos, size_t n) -> Spans {
+    if (buffer_.empty() || n == 0) {
+      return {};
+    }
+    const size_t start = pos & mask_;
+    const size_t first = std::min(n, buffer_.size() - start);
+    return {std::span<T>(buffer_.data() + start, first),
+            std::span<T>(buffer_.data(), n - first)};
+  }
+
+  static constexpr size_t cache_line = 64;
+
+  // producer-owned
+  alignas(cache_line) std::atomic<size_t> write_pos_{0};
+  size_t cached_read_pos_ = 0;
+  std::atomic<uint64_t> dropped_{0};
+
+  // consumer-owned
+  alignas(cache_line) std::atomic<size_t> read_pos_{0};
+
+  alignas(cache_line) std::vector<T> buffer_;
+  size_t mask_ = 0;
+};
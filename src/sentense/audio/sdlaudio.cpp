@@ -3,11 +3,7 @@
 #include <cstdio>
 #include <print>
 
-SDLAudio::SDLAudio(int len_ms) {
-  m_len_ms = len_ms;
-
-  m_running = false;
-}
+SDLAudio::SDLAudio(int len_ms) : AsyncAudio(len_ms) { m_running = false; }
 
 SDLAudio::~SDLAudio() {
   if (m_dev_id_in) {
@@ -89,9 +85,7 @@ auto SDLAudio::init(int sample_rate, const string &input) -> bool {
             capture_spec_obtained.samples);
   }
 
-  m_sample_rate = capture_spec_obtained.freq;
-
-  m_audio.resize((m_sample_rate * m_len_ms) / 1000);
+  init_ring(capture_spec_obtained.freq);
 
   return true;
 }
@@ -143,12 +137,7 @@ auto SDLAudio::clear() -> bool {
     return false;
   }
 
-  {
-    lock_guard<mutex> lock(m_mutex);
-
-    m_audio_pos = 0;
-    m_audio_len = 0;
-  }
+  ring_.clear();
 
   return true;
 }
@@ -159,75 +148,8 @@ void SDLAudio::callback(uint8_t *stream, int len) {
     return;
   }
 
-  size_t n_samples = len / sizeof(float);
-
-  if (n_samples > m_audio.size()) {
-    n_samples = m_audio.size();
-
-    stream += (len - (n_samples * sizeof(float)));
-  }
-
-  // fprintf(stderr, "%s: %zu samples, pos %zu, len %zu\n", __func__, n_samples,
-  // m_audio_pos, m_audio_len);
-
-  {
-    lock_guard<mutex> lock(m_mutex);
-
-    if (m_audio_pos + n_samples > m_audio.size()) {
-      const size_t n0 = m_audio.size() - m_audio_pos;
-
-      memcpy(&m_audio[m_audio_pos], stream, n0 * sizeof(float));
-      memcpy(&m_audio[0], stream + n0 * sizeof(float),
-             (n_samples - n0) * sizeof(float));
-    } else {
-      memcpy(&m_audio[m_audio_pos], stream, n_samples * sizeof(float));
-    }
-    m_audio_pos = (m_audio_pos + n_samples) % m_audio.size();
-    m_audio_len = min(m_audio_len + n_samples, m_audio.size());
-  }
-}
-
-void SDLAudio::get(int ms, vector<float> &result) {
-  if (!m_dev_id_in) {
-    println(stderr, "{}: no audio device to get audio from!", __func__);
-    return;
-  }
-
-  if (!m_running) {
-    println(stderr, "{}: not running!", __func__);
-    return;
-  }
-
-  result.clear();
-
-  {
-    lock_guard<mutex> lock(m_mutex);
-
-    if (ms <= 0) {
-      ms = m_len_ms;
-    }
-
-    size_t n_samples = (m_sample_rate * ms) / 1000;
-    if (n_samples > m_audio_len) {
-      n_samples = m_audio_len;
-    }
-
-    result.resize(n_samples);
-
-    int s0 = m_audio_pos - n_samples;
-    if (s0 < 0) {
-      s0 += m_audio.size();
-    }
-
-    if (s0 + n_samples > m_audio.size()) {
-      const size_t n0 = m_audio.size() - s0;
-
-      memcpy(result.data(), &m_audio[s0], n0 * sizeof(float));
-      memcpy(&result[n0], &m_audio[0], (n_samples - n0) * sizeof(float));
-    } else {
-      memcpy(result.data(), &m_audio[s0], n_samples * sizeof(float));
-    }
-  }
+  // runs on the SDL audio thread: no locks, no allocations
+  push_samples(reinterpret_cast<const float *>(stream), len / sizeof(float));
 }
 
 auto sdl_poll_events() -> bool {
@@ -244,11 +166,3 @@ auto sdl_poll_events() -> bool {
 
   return true;
 }
-
-auto AsyncAudio::create(const std::string &type, int len_ms)
-    -> std::unique_ptr<AsyncAudio> {
-  if (type == "sdl") {
-    return std::make_unique<SDLAudio>(len_ms);
-  }
-  return nullptr;
-}
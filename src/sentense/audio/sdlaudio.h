@@ -6,7 +6,6 @@
 #include "audio.h"
 #include <atomic>
 #include <cstdint>
-#include <mutex>
 #include <vector>
 
 using namespace std;
@@ -23,29 +22,18 @@ public:
   auto init(int sample_rate, const std::string &input = "") -> bool override;
 
   // start capturing audio via the provided SDL callback
-  // keep last len_ms seconds of audio in a circular buffer
+  // keep last len_ms seconds of audio in the lock-free capture ring
   auto resume() -> bool override;
   auto pause() -> bool override;
   auto clear() -> bool override;
 
-  // get audio data from the circular buffer
-  void get(int ms, vector<float> &audio) override;
-
 private:
   // callback to be called by SDL
   void callback(uint8_t *stream, int len);
 
   SDL_AudioDeviceID m_dev_id_in = 0;
 
-  int m_len_ms = 0;
-  int m_sample_rate = 0;
-
   atomic_bool m_running;
-  mutex m_mutex;
-
-  vector<float> m_audio;
-  size_t m_audio_pos = 0;
-  size_t m_audio_len = 0;
 };
 
 // Return false if need to quit
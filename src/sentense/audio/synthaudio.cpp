@@ -0,0 +1,63 @@
+#include "synthaudio.h"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numbers>
+
+auto SynthAudio::open(int sample_rate, const std::string &input) -> bool {
+  double seconds = 0; // empty: endless
+  if (!input.empty()) {
+    size_t parsed = 0;
+    try {
+      seconds = std::stod(input, &parsed);
+    } catch (const std::exception &) {
+      parsed = 0;
+    }
+    // the whole input must be a non-negative number ("60s" is not) whose
+    // sample count fits in total_
+    constexpr auto max_samples =
+        static_cast<double>(std::numeric_limits<uint64_t>::max() / 2);
+    if (parsed != input.size() || !(seconds >= 0) ||
+        seconds * sample_rate >= max_samples) {
+      std::cerr << "invalid synth duration: " << input << std::endl;
+      return false;
+    }
+  }
+  rate_ = sample_rate;
+  total_ = static_cast<uint64_t>(seconds * sample_rate);
+  pos_ = 0;
+  rng_.seed(1234);
+  return true;
+}
+
+auto SynthAudio::generate(float *out, size_t n) -> size_t {
+  if (total_ > 0) {
+    n = std::min<uint64_t>(n, total_ - pos_);
+  }
+
+  constexpr double two_pi = 2 * std::numbers::pi;
+  const double period = SPEECH_S + PAUSE_S;
+  for (size_t i = 0; i < n; ++i, ++pos_) {
+    const double t = static_cast<double>(pos_) / rate_;
+    const double phase = std::fmod(t, period);
+    float v = noise_(rng_);
+
+    if (phase < SPEECH_S) {
+      // pitch glides between bursts so consecutive sentences differ
+      const double f0 = 120.0 + 30.0 * std::sin(two_pi * t / 7.0);
+      const double envelope =
+          0.5 - 0.5 * std::cos(two_pi * 4.0 * phase); // ~4 syllables/s
+      double voiced = 0;
+      for (int h = 1; h <= 12; ++h) {
+        // rough formant weighting around 500 Hz and 1500 Hz
+        const double f = f0 * h;
+        const double w = std::exp(-std::pow((f - 500) / 300, 2)) +
+                         0.5 * std::exp(-std::pow((f - 1500) / 400, 2));
+        voiced += w * std::sin(two_pi * f * t);
+      }
+      v += static_cast<float>(0.2 * envelope * voiced);
+    }
+    out[i] = v;
+  }
+  return n;
+}
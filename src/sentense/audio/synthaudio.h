@@ -0,0 +1,30 @@
+#pragma once
+#include "pacedaudio.h"
+#include <cstdint>
+#include <random>
+
+//
+// Deterministic speech-like test signal: voiced bursts of harmonics with a
+// syllable-rate envelope, separated by pauses long enough to end a
+// sentence, over a low noise floor. Input: "[seconds][@speed]", where an
+// empty or zero duration runs forever.
+//
+class SynthAudio : public PacedAudio {
+public:
+  explicit SynthAudio(int len_ms = 2000) : PacedAudio(len_ms) {}
+  ~SynthAudio() override { shutdown(); }
+
+  static constexpr double SPEECH_S = 2.0; // length of a voiced burst
+  static constexpr double PAUSE_S = 1.0;  // silence between bursts
+
+protected:
+  auto open(int sample_rate, const std::string &input) -> bool override;
+  auto generate(float *out, size_t n) -> size_t override;
+
+private:
+  int rate_ = 16000;
+  uint64_t total_ = 0; // 0 = endless
+  uint64_t pos_ = 0;
+  std::mt19937 rng_{1234};
+  std::normal_distribution<float> noise_{0.0f, 0.003f};
+};
@@ -7,36 +7,55 @@
 #include <thread>
 
 Sentense::Sentense(const std::string &model_path, std::shared_ptr<EventBus> bus,
-                   int sample_rate)
+                   int sample_rate, CaptureMode mode,
+                   std::vector<std::string> inputs, const std::string &backend)
     : m_model_path(model_path), eventBus(std::move(bus)),
-      m_sample_rate(sample_rate),
-      m_vad(model_path, sample_rate, 32, 0.5, MIN_SENTENCE_GAP_MS, 30, 250) {
-
-#ifdef USE_SDL_AUDIO
-  m_audio_capture = AsyncAudio::create("sdl", BUFFER_DURATION_MS);
-#elif defined(USE_QT_AUDIO)
-  m_audio_capture = AsyncAudio::create("qt", BUFFER_DURATION_MS);
-#elif defined(USE_PIPEWIRE_AUDIO)
-  m_audio_capture = AsyncAudio::create("pipewire", BUFFER_DURATION_MS);
-#endif
-
-  // 计算环形缓冲区大小
-  size_t buffer_size = (m_sample_rate * BUFFER_DURATION_MS) / 1000;
-  m_ring_buffer.resize(buffer_size);
+      m_sample_rate(sample_rate), m_mode(mode) {
+
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    auto source = std::make_unique<Source>();
+    source->stream_id = static_cast<int>(i);
+
+    // 运行时按名称选择音频后端
+    auto [name, input] = AsyncAudio::split_source(inputs[i]);
+    if (name.empty())
+      name = backend.empty() ? AsyncAudio::default_backend() : backend;
+    // 合成信号没有设备，--audio-backend synth配合默认音频源时生成无限长的信号
+    if (name == "synth" && input == "default_output")
+      input = "";
+    source->backend = name;
+    source->input = input == "mic" ? "" : input;
+    source->capture = AsyncAudio::create(name, BUFFER_DURATION_MS);
+
+    // 每路音频源使用独立的VAD，流式状态互不影响
+    source->vad = std::make_unique<VadIterator>(
+        model_path, sample_rate, 32, 0.5, MIN_SENTENCE_GAP_MS, 30, 250,
+        MAX_SENTENCE_MS / 1000.0f);
+
+    // VAD以流式方式运行，检测到句子结束时立即回调
+    Source *src = source.get();
+    src->vad->on_speech_end = [this, src](const timestamp_t &speech) {
+      handleSpeech(*src, speech);
+    };
+    // 新句子开始时，从句子起点开始发布增量音频
+    src->vad->on_speech_start = [src](int start) {
+      src->partial_pos = src->vad_origin + start;
+    };
+
+    m_sources.push_back(std::move(source));
+  }
 
   eventBus->subscribe<StartServiceEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto startEvent = std::static_pointer_cast<StartServiceEvent>(event);
-        if (startEvent->serviceName == "sentense") {
+      [this](const StartServiceEvent &startEvent) {
+        if (startEvent.serviceName == "sentense") {
           start();
           eventBus->publish<ServiceStatusEvent>("sentense", true);
         }
       });
 
   eventBus->subscribe<StopServiceEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto stopEvent = std::static_pointer_cast<StopServiceEvent>(event);
-        if (stopEvent->serviceName == "sentense") {
+      [this](const StopServiceEvent &stopEvent) {
+        if (stopEvent.serviceName == "sentense") {
           stop();
           eventBus->publish<ServiceStatusEvent>("sentence", false);
         }
@@ -46,12 +65,34 @@ Sentense::Sentense(const std::string &model_path, std::shared_ptr<EventBus> bus,
 Sentense::~Sentense() { stop(); }
 
 auto Sentense::initialize() -> bool {
-
-  if (!m_audio_capture->init(m_sample_rate)) {
-    std::cerr << "Failed to initialize audio capture" << std::endl;
+  if (m_sources.empty()) {
+    std::cerr << "No audio source configured" << std::endl;
     return false;
   }
 
+  for (auto &source : m_sources) {
+    if (source->backend.empty()) {
+      std::cerr << "No capture backend built in, use --source file:... or "
+                   "--source synth:..."
+                << std::endl;
+      return false;
+    }
+    if (!source->capture) {
+      std::cerr << "Unknown audio backend '" << source->backend
+                << "', available:";
+      for (const auto &name : AsyncAudio::backends())
+        std::cerr << " " << name;
+      std::cerr << std::endl;
+      return false;
+    }
+    if (!source->capture->init(m_sample_rate, source->input)) {
+      std::cerr << "Failed to initialize audio capture for source "
+                << source->stream_id << " '" << source->backend << ":"
+                << source->input << "'" << std::endl;
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -60,170 +101,226 @@ void Sentense::start() {
     return;
 
   m_running = true;
-  m_audio_capture->resume();
-
-  // 启动处理线程
-  std::thread([this]() {
-    while (m_running) {
-      auto start = std::chrono::steady_clock::now();
-
-      // 处理音频数据
-      processAudio();
-
-      // 检查是否有完整句子
-      checkForSentences();
-
-      // 等待直到下一个处理周期
-      auto end = std::chrono::steady_clock::now();
-      auto elapsed =
-          std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-      if (elapsed.count() < PROCESS_INTERVAL_MS) {
-        std::this_thread::sleep_for(
-            std::chrono::milliseconds(PROCESS_INTERVAL_MS - elapsed.count()));
-      }
-    }
-  }).detach();
+  for (auto &source : m_sources) {
+    source->capture->set_notify_ms(m_mode == CaptureMode::Push ? PUSH_BLOCK_MS
+                                                                : 0);
+    source->capture->resume();
+
+    // 每路音频源一个处理线程
+    source->thread = std::thread(&Sentense::run, this, std::ref(*source));
+  }
 }
 
-void Sentense::stop() {
-  m_running = false;
-  m_audio_capture->pause();
+void Sentense::run(Source &source) {
+  while (m_running) {
+    if (m_mode == CaptureMode::Push) {
+      // 等待音频后端通知，超时后检查是否已停止
+      if (!source.capture->wait_for_data(100))
+        continue;
 
-  // 处理残留音频
-  std::lock_guard<std::mutex> lock(m_buffer_mutex);
+      processAudio(source);
+      continue;
+    }
 
-  if (m_buffer_fill == 0 || !eventBus) {
-    m_buffer_pos = 0;
-    return;
-  }
+    auto start = std::chrono::steady_clock::now();
 
-  // 从缓冲区中提取数据用于VAD处理
-  std::vector<float> audio_for_vad = extractAudioForVAD();
+    // 处理新音频，VAD检测到的句子会立即发送
+    processAudio(source);
 
-  // 使用VAD处理音频
-  m_vad.process(audio_for_vad);
-  auto speeches = m_vad.get_speech_timestamps();
+    // 等待直到下一个处理周期
+    std::unique_lock<std::mutex> lock(m_wake_mutex);
+    m_wake_cv.wait_until(lock,
+                         start + std::chrono::milliseconds(PROCESS_INTERVAL_MS),
+                         [this]() { return !m_running; });
+  }
+}
 
-  if (!speeches.empty()) {
-    std::vector<float> sentence(audio_for_vad.begin() + speeches[0].start,
-                                audio_for_vad.begin() + speeches[0].end);
-    eventBus->publish<AudioAddedEvent>(sentence);
+void Sentense::stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_wake_mutex);
+    m_running = false;
   }
+  m_wake_cv.notify_all();
 
-  m_buffer_fill = 0;
-  m_buffer_pos = 0;
-  m_vad.reset();
-}
+  for (auto &source : m_sources) {
+    if (source->thread.joinable())
+      source->thread.join();
+  }
 
-void Sentense::processAudio() {
-  // 从音频捕获获取最新数据
-  std::vector<float> new_audio;
-  m_audio_capture->get(PROCESS_INTERVAL_MS, new_audio);
+  for (auto &source : m_sources) {
+    if (!source->capture)
+      continue;
 
-  if (new_audio.empty())
-    return;
+    source->capture->pause();
 
-  std::lock_guard<std::mutex> lock(m_buffer_mutex);
+    // 处理线程最后一次读取之后采集的音频
+    processAudio(*source);
 
-  // 将新数据添加到环形缓冲区
-  size_t samples_to_add = new_audio.size();
-  if (samples_to_add > m_ring_buffer.size()) {
-    // 如果新数据比整个缓冲区还大，只保留最后的部分
-    new_audio.erase(new_audio.begin(), new_audio.end() - m_ring_buffer.size());
-    samples_to_add = m_ring_buffer.size();
+    // 处理残留音频：关闭仍未结束的语音段，然后释放全部音频
+    std::lock_guard<std::mutex> lock(source->buffer_mutex);
+
+    source->view = source->capture->peek();
+    source->vad->flush_stream();
+    source->capture->consume(source->view.size());
+
+    source->view = {};
+    source->consumed = 0;
+    source->vad_pos = 0;
+    source->vad_origin = 0;
+    source->partial_pos = 0;
+    source->sentence_end = 0;
+    source->vad->reset();
   }
+}
 
-  // 计算写入位置
-  size_t write_pos = m_buffer_pos;
-  size_t first_chunk =
-      std::min(samples_to_add, m_ring_buffer.size() - write_pos);
-  size_t second_chunk = samples_to_add - first_chunk;
+void Sentense::processAudio(Source &source) {
+  std::lock_guard<std::mutex> lock(source.buffer_mutex);
+  auto &vad = *source.vad;
 
-  // 写入数据
-  std::copy(new_audio.begin(), new_audio.begin() + first_chunk,
-            m_ring_buffer.begin() + write_pos);
+  // 零拷贝获取尚未释放的音频，vad_pos之后的部分是新采集的
+  source.view = source.capture->peek();
+  auto new_audio =
+      source.view.subview(source.vad_pos - source.consumed, source.view.size());
 
-  if (second_chunk > 0) {
-    std::copy(new_audio.begin() + first_chunk, new_audio.end(),
-              m_ring_buffer.begin());
-  }
+  if (new_audio.empty())
+    return;
 
-  // 更新位置和填充量
-  m_buffer_pos = (write_pos + samples_to_add) % m_ring_buffer.size();
-  m_buffer_fill =
-      std::min(m_buffer_fill + samples_to_add, m_ring_buffer.size());
-}
+  source.last_read = std::chrono::steady_clock::now();
 
-// unsafe operation
-auto Sentense::extractAudioForVAD() const -> vector<float> {
-  vector<float> audio_for_vad;
-  audio_for_vad.reserve(m_buffer_fill);
+  // 长时间静默后重置VAD，避免采样计数溢出
+  if (!vad.is_triggered() && vad.get_current_sample() > (1 << 30)) {
+    vad.reset();
+    source.vad_origin = source.vad_pos;
+  }
 
-  if (m_buffer_pos >= m_buffer_fill) {
-    audio_for_vad.assign(m_ring_buffer.begin() + (m_buffer_pos - m_buffer_fill),
-                         m_ring_buffer.begin() + m_buffer_pos);
+  // 只把新采集的音频送入VAD，状态在多次调用间保持；
+  // 积压较多时（轮询间隔或线程被延迟）改用批量推理
+  if (new_audio.size() >
+      static_cast<size_t>(m_sample_rate) * VAD_BATCH_MS / 1000) {
+    vad.process_stream_batched(new_audio.first, VAD_BATCH_LANES);
+    vad.process_stream_batched(new_audio.second, VAD_BATCH_LANES);
   } else {
-    size_t first_chunk = m_ring_buffer.size() - (m_buffer_fill - m_buffer_pos);
-    audio_for_vad.assign(m_ring_buffer.begin() + first_chunk,
-                         m_ring_buffer.end());
-    audio_for_vad.insert(audio_for_vad.end(), m_ring_buffer.begin(),
-                         m_ring_buffer.begin() + m_buffer_pos);
+    vad.process_stream(new_audio.first);
+    vad.process_stream(new_audio.second);
   }
+  source.vad_pos += new_audio.size();
 
-  return std::move(audio_for_vad); // 显式移动
+  publishPartial(source);
+  releaseAudio(source);
 }
 
-void Sentense::checkForSentences() {
-  std::lock_guard<std::mutex> lock(m_buffer_mutex);
-
-  if (m_buffer_fill == 0 || !eventBus)
+void Sentense::publishPartial(Source &source) {
+  if (!m_partial_enabled || !source.vad->is_triggered())
     return;
 
-  // 从缓冲区中提取数据用于VAD处理
-  std::vector<float> audio_for_vad = extractAudioForVAD();
-
-  // 使用VAD处理音频
-  m_vad.process(audio_for_vad);
-  auto speeches = m_vad.get_speech_timestamps();
+  AudioChunk audio = extractAudio(source, source.partial_pos, source.vad_pos);
+  source.partial_pos = source.vad_pos;
+  if (!audio.empty())
+    eventBus->publish<AudioPartialEvent>(std::move(audio), source.stream_id);
+}
 
-  if (speeches.empty()) {
-    m_buffer_fill = 0;
-    return;
+// 释放不再需要的音频：保留尚未经过VAD推理的部分(包括VAD中不足一个窗口的
+// 采样，下一个语音段可能从那里开始)，语音段未结束时保留其起点之后的部分，
+// 两者之前再多保留PRE_ROLL_MS
+void Sentense::releaseAudio(Source &source) {
+  uint64_t keep_from = source.vad_origin + source.vad->get_processed_sample();
+  int speech_start = source.vad->get_speech_start();
+  if (speech_start >= 0) {
+    keep_from = std::min(keep_from, source.vad_origin + speech_start);
   }
+  const uint64_t pre_roll = m_sample_rate * PRE_ROLL_MS / 1000;
+  keep_from -= std::min(keep_from, pre_roll);
 
-  size_t start = speeches[0].start;
-  size_t end = speeches[0].end;
-
-  // 处理检测到的语音段
-  for (size_t i = 0; i < speeches.size() - 1; i++) {
-    const auto &speech = speeches[i];
-    if (speech.end - speech.start < (m_sample_rate * 100) / 1000) {
-      // 忽略太短的语音段（小于100ms）
-      continue;
-    }
-    end = speech.end;
-
-    // 提取完整句子
-    std::vector<float> sentence(audio_for_vad.begin() + start,
-                                audio_for_vad.begin() + end);
+  if (keep_from > source.consumed) {
+    source.capture->consume(keep_from - source.consumed);
+    source.consumed = keep_from;
+  }
+  source.view = {};
+}
 
-    // 通过回调返回句子
-    eventBus->publish<AudioAddedEvent>(sentence);
+// unsafe operation: caller must hold source.buffer_mutex
+// 这是句子音频唯一一次复制，之后以AudioChunk共享
+auto Sentense::extractAudio(const Source &source, uint64_t begin,
+                            uint64_t end) -> AudioChunk {
+  // 只能取到尚未释放的部分
+  begin = std::max(begin, source.consumed);
+  if (begin >= end)
+    return {};
+
+  auto view = source.view.subview(begin - source.consumed, end - begin);
+
+  // 由最近一次读取的时间倒推第一个采样的采集时间
+  uint64_t captured = source.consumed + source.view.size();
+  auto captured_at =
+      source.last_read -
+      std::chrono::duration_cast<AudioChunk::Clock::duration>(
+          std::chrono::duration<double>(static_cast<double>(captured - begin) /
+                                        m_sample_rate));
+
+  return m_audio_pool.make_chunk(view.size(), m_sample_rate, captured_at,
+                                 [&view](float *out) { view.copy_to(out); });
+}
 
-    start = speeches[i + 1].start;
-    end = speeches[i + 1].end;
+// 由VAD在语音段结束时回调，调用者持有source.buffer_mutex
+void Sentense::handleSpeech(Source &source, const timestamp_t &speech) {
+  if (speech.end - speech.start < (m_sample_rate * MIN_SENTENCE_MS) / 1000) {
+    // 忽略太短的语音段
+    return;
   }
 
-  if (m_buffer_fill - end >= PROCESS_INTERVAL_MS * m_sample_rate / 1000) {
-    std::vector<float> sentence(audio_for_vad.begin() + start,
-                                audio_for_vad.begin() + end);
-    eventBus->publish<AudioAddedEvent>(sentence);
+  // 句子前带上PRE_ROLL_MS，避免起始的辅音被截掉，但不与上一句重叠
+  const uint64_t pre_roll = m_sample_rate * PRE_ROLL_MS / 1000;
+  const uint64_t start = source.vad_origin + speech.start;
+  const uint64_t begin =
+      std::max(start - std::min(start, pre_roll), source.sentence_end);
+  source.sentence_end = source.vad_origin + speech.end;
+  AudioChunk sentence = extractAudio(source, begin, source.sentence_end);
+  if (sentence.empty())
+    return;
 
-    m_buffer_fill = 0;
-    m_buffer_pos = 0;
-  } else {
-    m_buffer_fill -= start;
+  // 最近一次读取时，语音结束之后又采集了(captured - end)个采样
+  uint64_t captured = source.consumed + source.view.size();
+  uint64_t end = source.vad_origin + speech.end;
+  double latency_ms =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - source.last_read)
+          .count() +
+      (captured - end) * 1000.0 / m_sample_rate;
+
+  {
+    std::lock_guard<std::mutex> lock(m_latency_mutex);
+    m_latency.count++;
+    m_latency.last_ms = latency_ms;
+    m_latency.mean_ms += (latency_ms - m_latency.mean_ms) / m_latency.count;
+    m_latency.max_ms = std::max(m_latency.max_ms, latency_ms);
   }
+  m_sentences_metric.add();
+  m_latency_metric.record(
+      std::chrono::duration<double, std::milli>(latency_ms));
+
+  // 说话本身和检测到句子结束各记一段，句子编号即跟踪编号
+  const uint64_t id = next_sentence_id();
+  auto &tracer = Tracer::instance();
+  const auto spoken_end =
+      sentence.captured_at() +
+      std::chrono::duration_cast<AudioChunk::Clock::duration>(
+          sentence.duration());
+  tracer.record("speech", id, sentence.captured_at(), spoken_end,
+                source.stream_id);
+  tracer.record("detect", id, spoken_end, std::chrono::steady_clock::now(),
+                source.stream_id);
+
+  eventBus->publish<AudioAddedEvent>(std::move(sentence), source.stream_id,
+                                     id);
+}
+
+auto Sentense::latency_stats() const -> LatencyStats {
+  std::lock_guard<std::mutex> lock(m_latency_mutex);
+  return m_latency;
+}
 
-  m_vad.reset();
+auto Sentense::finished() const -> bool {
+  return std::ranges::all_of(m_sources, [](const auto &source) {
+    return source->capture && source->capture->finished();
+  });
 }
@@ -2,44 +2,125 @@
 #pragma once
 
 #include "audio.h"
+#include "audiochunk.h"
+#include "audiopool.h"
 #include "eventbus.h"
+#include "metrics.h"
 #include "silero-vad-onnx.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 class Sentense {
 public:
+  // Poll: 每PROCESS_INTERVAL_MS读取一次音频
+  // Push: 音频后端每采集到一个VAD窗口就唤醒处理线程
+  enum class CaptureMode { Poll, Push };
+
+  // 句子发布延迟：从语音结束的采样被采集到句子发布
+  struct LatencyStats {
+    size_t count = 0;
+    double last_ms = 0;
+    double mean_ms = 0;
+    double max_ms = 0;
+  };
+
+  // inputs: 每个元素是一路音频源，格式为"[后端:]输入"，输入部分传给
+  // AsyncAudio::init()，例如"default_output"(系统输出)、"mic"(默认麦克风)、
+  // 应用名称、"file:talk.wav@4"或"synth:60"。未指定后端时使用backend，
+  // backend为空时使用AsyncAudio::default_backend()。
+  // 句子事件中的stream_id即该音频源在inputs中的下标。
   Sentense(const std::string &model_path, std::shared_ptr<EventBus> bus,
-           int sample_rate = 16000);
+           int sample_rate = 16000, CaptureMode mode = CaptureMode::Poll,
+           std::vector<std::string> inputs = {"default_output"},
+           const std::string &backend = "");
   ~Sentense();
 
   auto initialize() -> bool;
+  [[nodiscard]] auto latency_stats() const -> LatencyStats;
+  // 句子音频缓冲区池的统计，用于观察稳定运行时的内存分配次数
+  [[nodiscard]] auto pool_stats() const -> AudioPool::Stats {
+    return m_audio_pool.stats();
+  }
+  // 所有音频源均已结束(文件回放完毕等)，实时采集的音频源永远不会结束
+  [[nodiscard]] auto finished() const -> bool;
+
+  // 句子进行中时以AudioPartialEvent发布新采集的音频，供流式识别使用
+  void setPartialEnabled(bool enabled) { m_partial_enabled = enabled; }
 
 private:
+  // 一路音频源：独立的采集后端、流式VAD状态和处理线程
+  struct Source {
+    int stream_id;
+    std::string backend;
+    std::string input;
+    std::unique_ptr<AsyncAudio> capture;
+    std::unique_ptr<VadIterator> vad;
+    std::thread thread;
+    std::mutex buffer_mutex;
+
+    // 音频留在采集缓冲区中，下列游标均为累计采样数
+    RingView<float> view;      // 尚未释放的音频(零拷贝)
+    uint64_t consumed = 0;     // 已释放回采集缓冲区的采样数，即view的起点
+    uint64_t vad_pos = 0;      // 已送入VAD的采样数
+    uint64_t vad_origin = 0;   // VAD上次reset时的累计采样数
+    uint64_t partial_pos = 0;  // 已作为AudioPartialEvent发布的采样数
+    uint64_t sentence_end = 0; // 上一句的结束位置
+    std::chrono::steady_clock::time_point last_read; // 最近一次读取音频的时间
+  };
+
   void start();
   void stop();
-  void processAudio();
-  void checkForSentences();
-  [[nodiscard]] auto extractAudioForVAD() const -> vector<float>;
+  void run(Source &source);
+  void processAudio(Source &source);
+  void releaseAudio(Source &source);
+  void handleSpeech(Source &source, const timestamp_t &speech);
+  void publishPartial(Source &source);
+  [[nodiscard]] auto extractAudio(const Source &source, uint64_t begin,
+                                  uint64_t end) -> AudioChunk;
 
   // Configuration
   const std::string m_model_path;
   const int m_sample_rate;
+  const CaptureMode m_mode;
 
   // Components
-  std::unique_ptr<AsyncAudio> m_audio_capture;
-  VadIterator m_vad;
+  std::vector<std::unique_ptr<Source>> m_sources;
   std::shared_ptr<EventBus> eventBus;
 
-  // Buffers and state
-  std::vector<float> m_ring_buffer;
-  size_t m_buffer_pos = 0;
-  size_t m_buffer_fill = 0;
-  bool m_running = false;
-  std::mutex m_buffer_mutex;
+  std::atomic_bool m_partial_enabled = false;
+  std::atomic_bool m_running = false;
+  std::mutex m_wake_mutex;
+  std::condition_variable m_wake_cv; // 用于stop()打断轮询等待
+
+  // 句子和增量音频从池中取缓冲区，识别完成后回收
+  AudioPool m_audio_pool;
+
+  LatencyStats m_latency;
+  mutable std::mutex m_latency_mutex;
+
+  // 供MonitorWindow显示：发送的句子数和检测延迟
+  Counter &m_sentences_metric =
+      Metrics::instance().counter("sentense.sentences");
+  Histogram &m_latency_metric =
+      Metrics::instance().histogram("sentense.latency");
 
   // Processing parameters
-  static constexpr int BUFFER_DURATION_MS = 50000; // 5秒环形缓冲区
+  static constexpr int BUFFER_DURATION_MS = 50000; // 50秒采集缓冲区
   static constexpr int PROCESS_INTERVAL_MS = 2000; // 每2000ms处理一次
+  static constexpr int PUSH_BLOCK_MS = 32;         // Push模式：一个VAD窗口
   static constexpr int MIN_SENTENCE_GAP_MS = 500;  // 500ms静默视为句子结束
+  static constexpr int MIN_SENTENCE_MS = 100;      // 忽略小于100ms的语音段
+  static constexpr int PRE_ROLL_MS = 100;          // 句子起点之前多保留100ms
+  static constexpr int VAD_BATCH_MS = 4000; // 积压超过4秒时批量推理追赶
+  static constexpr int VAD_BATCH_LANES = 8; // 批量推理的并行通道数
+  // 句子最长时长，保证整句仍在环形缓冲区内
+  static constexpr int MAX_SENTENCE_MS =
+      BUFFER_DURATION_MS - PROCESS_INTERVAL_MS;
 };
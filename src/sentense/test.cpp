@@ -8,6 +8,7 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <span>
 #include <sstream>
 #include <thread>
 #include <vector>
@@ -50,7 +51,7 @@ void ensureWavDirectoryExists() {
   }
 }
 
-void saveAsWav(const std::vector<float> &audio, int sampleRate,
+void saveAsWav(std::span<const float> audio, int sampleRate,
                const std::string &filename) {
   std::ofstream file(filename, std::ios::binary);
   if (!file) {
@@ -96,49 +97,82 @@ auto getTimestampFilename(const std::string &prefix,
   return "wav/" + prefix + ss.str() + "." + extension;
 }
 
-auto main() -> int {
+auto main(int argc, char **argv) -> int {
   // 注册信号处理函数
   signal(SIGINT, signalHandler);
   signal(SIGTERM, signalHandler);
 
+  // ./sentense_test push 使用事件驱动模式，默认为轮询模式
+  // ./sentense_test poll default_output mic 同时采集多路音频源
+  // ./sentense_test push file:talk.wav@0 synth:60@0 不依赖音频设备，
+  // 音频源全部结束后自动退出
+  auto mode = (argc > 1 && std::string(argv[1]) == "push")
+                  ? Sentense::CaptureMode::Push
+                  : Sentense::CaptureMode::Poll;
+  std::vector<std::string> inputs(argv + std::min(argc, 2), argv + argc);
+  if (inputs.empty()) {
+    inputs.emplace_back("default_output");
+  }
+
   auto eventBus = std::make_shared<EventBus>();
 
   ensureWavDirectoryExists();
 
-  Sentense sen("../../models/silero_vad.onnx", eventBus);
+  Sentense sen("../../models/silero_vad.onnx", eventBus, 16000, mode, inputs);
 
   if (!sen.initialize()) {
     std::cerr << "Failed to initialize sen processor" << std::endl;
     return 1;
   }
 
-  eventBus->subscribe<AudioAddedEvent>([](const std::shared_ptr<Event> &event) {
-    auto dataEvent = std::static_pointer_cast<AudioAddedEvent>(event);
-    auto sentence = dataEvent->audio;
-    static int counter = 0;
-    if (!g_running)
-      return; // 如果收到停止信号，不再处理新句子
+  eventBus->subscribe<AudioAddedEvent>(
+      [&sen](const AudioAddedEvent &dataEvent) {
+        const auto &sentence = dataEvent.audio;
+        static std::atomic<int> counter = 0;
+        if (!g_running)
+          return; // 如果收到停止信号，不再处理新句子
+
+        std::cout << "Detected sentence #" << ++counter << " on stream "
+                  << dataEvent.stream_id << " with " << sentence.size()
+                  << " samples" << std::endl;
 
-    std::cout << "Detected sentence #" << ++counter << " with "
-              << sentence.size() << " samples" << std::endl;
+        std::string filename = getTimestampFilename("sentence_", "wav");
+        saveAsWav(sentence.samples(), sentence.sample_rate(), filename);
 
-    std::string filename = getTimestampFilename("sentence_", "wav");
-    saveAsWav(sentence, 16000, filename);
+        std::cout << "Saved to: " << filename << std::endl;
 
-    std::cout << "Saved to: " << filename << std::endl;
-  });
+        auto latency = sen.latency_stats();
+        std::cout << "End-of-sentence latency: " << latency.last_ms << " ms"
+                  << std::endl;
+      });
 
   std::cout << "Starting voice detection. Press Ctrl+C to stop..." << std::endl;
   std::cout << "WAV files will be saved in 'wav/' directory" << std::endl;
   eventBus->publish<StartServiceEvent>("sentense");
 
   // 主循环 - 现在检查g_running标志
-  while (g_running) {
+  while (g_running && !sen.finished()) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
   }
+  if (g_running) {
+    // 等待最后一次轮询处理完剩余的音频
+    std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+  }
 
   std::cout << "Stopping voice detection..." << std::endl;
   eventBus->publish<StopServiceEvent>("sentense");
+
+  auto latency = sen.latency_stats();
+  std::cout << "Mode: "
+            << (mode == Sentense::CaptureMode::Push ? "push" : "poll")
+            << ", sentences: " << latency.count
+            << ", mean latency: " << latency.mean_ms << " ms"
+            << ", max latency: " << latency.max_ms << " ms" << std::endl;
+  auto pool = sen.pool_stats();
+  std::cout << "Audio pool: " << pool.chunks << " chunks, "
+            << pool.heap_allocations << " allocations ("
+            << pool.allocations_per_minute(16000) << " per minute of audio), "
+            << pool.bytes / 1024 << " KiB" << std::endl;
   std::cout << "Program terminated gracefully." << std::endl;
   return 0;
 }
@@ -0,0 +1,76 @@
+#include "silero-vad-onnx.h"
+#include "test-audio.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Compares per-window and batched VadIterator inference.
+//
+//   vad_bench <model.onnx> [input.wav] [lanes]
+//
+// input.wav must be 16 kHz mono 16-bit PCM. Without it a minute of
+// synthetic audio (noise with tone bursts) is used.
+
+namespace {
+
+template <typename F> auto time_ms(F &&f) -> double {
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    cerr << "usage: " << argv[0] << " <model.onnx> [input.wav] [lanes]\n";
+    return 1;
+  }
+  const int sample_rate = 16000;
+  const int window = 512;
+
+  vector<float> wav;
+  if (argc > 2 && !read_wav(argv[2], wav)) {
+    cerr << "failed to read " << argv[2] << '\n';
+    return 1;
+  }
+  if (wav.empty())
+    wav = synth(sample_rate, 60, 42);
+  const int lanes = argc > 3 ? atoi(argv[3]) : 8;
+  const double windows = static_cast<double>(wav.size() / window);
+
+  VadIterator vad(argv[1], sample_rate);
+
+  // Warm up the session once so both runs see the same allocator state.
+  vad.process(wav);
+
+  vector<timestamp_t> serial, batched;
+  const double serial_ms = time_ms([&] {
+    vad.process(wav);
+    serial = vad.get_speech_timestamps();
+  });
+  const double batched_ms = time_ms([&] {
+    vad.process_batch(wav, lanes);
+    batched = vad.get_speech_timestamps();
+  });
+
+  cout << "audio:    " << wav.size() / sample_rate << " s, " << windows
+       << " windows\n";
+  cout << "serial:   " << serial_ms << " ms, " << windows * 1000 / serial_ms
+       << " windows/s\n";
+  cout << "batched:  " << batched_ms << " ms, " << windows * 1000 / batched_ms
+       << " windows/s (" << lanes << " lanes)\n";
+  cout << "speedup:  " << serial_ms / batched_ms << "x\n";
+
+  // Lanes after the first start from a warmed-up zero state, so boundaries
+  // may move by a window or two near lane splits.
+  cout << "segments: " << serial.size() << " serial, " << batched.size()
+       << " batched\n";
+  for (size_t i = 0; i < max(serial.size(), batched.size()); ++i) {
+    const string a = i < serial.size() ? serial[i].c_str() : "-";
+    const string b = i < batched.size() ? batched[i].c_str() : "-";
+    cout << (a == b ? "  " : "! ") << a << "  " << b << '\n';
+  }
+  return 0;
+}
@@ -24,40 +24,69 @@ void VadIterator::reset_states() {
   speeches.clear();
   current_speech = timestamp_t();
   fill(_context.begin(), _context.end(), 0.0f);
+  _pending.clear();
+}
+
+// Records a closed speech segment and notifies on_speech_end.
+void VadIterator::emit_speech(const timestamp_t &speech) {
+  speeches.push_back(speech);
+  if (on_speech_end)
+    on_speech_end(speech);
 }
 
 // Inference: runs inference on one chunk of input data.
 // data_chunk is expected to have window_size_samples samples.
-void VadIterator::predict(const vector<float> &data_chunk) {
-  // Build new input: first context_samples from _context, followed by the
-  // current chunk (window_size_samples).
-  vector<float> new_data(effective_window_size, 0.0f);
-  copy(_context.begin(), _context.end(), new_data.begin());
-  copy(data_chunk.begin(), data_chunk.end(),
-       new_data.begin() + context_samples);
-  input = new_data;
-
-  // Create input tensor (input_node_dims[1] is already set to
-  // effective_window_size).
-  Ort::Value input_ort = Ort::Value::CreateTensor<float>(
-      memory_info, input.data(), input.size(), input_node_dims, 2);
-  Ort::Value state_ort = Ort::Value::CreateTensor<float>(
-      memory_info, _state.data(), _state.size(), state_node_dims, 3);
-  Ort::Value sr_ort = Ort::Value::CreateTensor<int64_t>(
-      memory_info, sr.data(), sr.size(), sr_node_dims, 1);
+void VadIterator::predict(span<const float> data_chunk) {
+  const auto started = chrono::steady_clock::now();
+  const float speech_prob = infer(data_chunk);
+  _inference_metric->record(chrono::steady_clock::now() - started);
+  update(speech_prob);
+}
+
+// Binds the single-window tensors to the member buffers once. The buffers
+// are sized in the constructor and never reallocated afterwards.
+void VadIterator::bind_tensors() {
   ort_inputs.clear();
-  ort_inputs.emplace_back(move(input_ort));
-  ort_inputs.emplace_back(move(state_ort));
-  ort_inputs.emplace_back(move(sr_ort));
-
-  // Run inference.
-  ort_outputs = session->Run(
-      Ort::RunOptions{nullptr}, input_node_names.data(), ort_inputs.data(),
-      ort_inputs.size(), output_node_names.data(), output_node_names.size());
-
-  float speech_prob = ort_outputs[0].GetTensorMutableData<float>()[0];
-  float *stateN = ort_outputs[1].GetTensorMutableData<float>();
-  memcpy(_state.data(), stateN, size_state * sizeof(float));
+  ort_inputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, input.data(), input.size(), input_node_dims, 2));
+  ort_inputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, _state.data(), _state.size(), state_node_dims, 3));
+  ort_inputs.emplace_back(Ort::Value::CreateTensor<int64_t>(
+      memory_info, sr.data(), sr.size(), sr_node_dims, 1));
+
+  ort_outputs.clear();
+  ort_outputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, _output.data(), _output.size(), output_node_dims, 2));
+  ort_outputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, _stateN.data(), _stateN.size(), state_node_dims, 3));
+}
+
+// Runs the model on one window and carries the LSTM state and context over
+// to the next window. Returns the speech probability.
+//
+// Allocation free: the input is assembled in place in `input`, and the
+// model writes into the preallocated `_output` and `_stateN` buffers.
+float VadIterator::infer(span<const float> data_chunk) {
+  // Input layout: context_samples from _context, followed by the current
+  // chunk (window_size_samples).
+  copy(_context.begin(), _context.end(), input.begin());
+  copy(data_chunk.begin(), data_chunk.begin() + window_size_samples,
+       input.begin() + context_samples);
+
+  session->Run(Ort::RunOptions{nullptr}, input_node_names.data(),
+               ort_inputs.data(), ort_inputs.size(), output_node_names.data(),
+               ort_outputs.data(), ort_outputs.size());
+
+  memcpy(_state.data(), _stateN.data(), size_state * sizeof(float));
+
+  // Update context: copy the last context_samples of this input.
+  copy(input.end() - context_samples, input.end(), _context.begin());
+  return _output[0];
+}
+
+// Advances the segment state machine by one window.
+void VadIterator::update(float speech_prob) {
+  _windows_metric->add();
   current_sample += static_cast<unsigned int>(
       window_size_samples); // Advance by the original window size.
 
@@ -76,9 +105,9 @@ void VadIterator::predict(const vector<float> &data_chunk) {
     if (!triggered) {
       triggered = true;
       current_speech.start = current_sample - window_size_samples;
+      if (on_speech_start)
+        on_speech_start(current_speech.start);
     }
-    // Update context: copy the last context_samples from new_data.
-    copy(new_data.end() - context_samples, new_data.end(), _context.begin());
     return;
   }
 
@@ -87,32 +116,33 @@ void VadIterator::predict(const vector<float> &data_chunk) {
       ((current_sample - current_speech.start) > max_speech_samples)) {
     if (prev_end > 0) {
       current_speech.end = prev_end;
-      speeches.push_back(current_speech);
+      emit_speech(current_speech);
       current_speech = timestamp_t();
-      if (next_start < prev_end)
+      if (next_start < prev_end) {
         triggered = false;
-      else
+      } else {
         current_speech.start = next_start;
+        if (on_speech_start)
+          on_speech_start(current_speech.start);
+      }
       prev_end = 0;
       next_start = 0;
       temp_end = 0;
     } else {
       current_speech.end = current_sample;
-      speeches.push_back(current_speech);
+      emit_speech(current_speech);
       current_speech = timestamp_t();
       prev_end = 0;
       next_start = 0;
       temp_end = 0;
       triggered = false;
     }
-    copy(new_data.end() - context_samples, new_data.end(), _context.begin());
     return;
   }
 
   if ((speech_prob >= (threshold - 0.15)) && (speech_prob < threshold)) {
     // When the speech probability temporarily drops but is still in speech,
-    // update context without changing state.
-    copy(new_data.end() - context_samples, new_data.end(), _context.begin());
+    // keep the current state.
     return;
   }
 
@@ -130,7 +160,7 @@ void VadIterator::predict(const vector<float> &data_chunk) {
       if ((current_sample - temp_end) >= min_silence_samples) {
         current_speech.end = temp_end;
         if (current_speech.end - current_speech.start > min_speech_samples) {
-          speeches.push_back(current_speech);
+          emit_speech(current_speech);
           current_speech = timestamp_t();
           prev_end = 0;
           next_start = 0;
@@ -139,7 +169,6 @@ void VadIterator::predict(const vector<float> &data_chunk) {
         }
       }
     }
-    copy(new_data.end() - context_samples, new_data.end(), _context.begin());
     return;
   }
 }
@@ -148,18 +177,198 @@ void VadIterator::predict(const vector<float> &data_chunk) {
 void VadIterator::process(const vector<float> &input_wav) {
   reset_states();
   audio_length_samples = static_cast<int>(input_wav.size());
+  process_stream(input_wav);
+  flush_stream();
+}
+
+// Completes a window split across calls from _pending. Returns the number
+// of samples taken from new_samples.
+size_t VadIterator::fill_pending(span<const float> new_samples) {
+  if (_pending.empty())
+    return 0;
+  const auto window = static_cast<size_t>(window_size_samples);
+  size_t n = min(window - _pending.size(), new_samples.size());
+  _pending.insert(_pending.end(), new_samples.begin(), new_samples.begin() + n);
+  if (_pending.size() == window) {
+    predict(_pending);
+    _pending.clear();
+  }
+  return n;
+}
+
+// Streaming mode: consumes only the new samples. A window split across two
+// calls is completed from _pending first.
+void VadIterator::process_stream(span<const float> new_samples) {
+  speeches.clear();
+  const auto window = static_cast<size_t>(window_size_samples);
+  size_t pos = fill_pending(new_samples);
+  if (!_pending.empty())
+    return;
+
   // Process audio in chunks of window_size_samples (e.g., 512 samples)
-  for (size_t j = 0; j < static_cast<size_t>(audio_length_samples);
-       j += static_cast<size_t>(window_size_samples)) {
-    if (j + static_cast<size_t>(window_size_samples) >
-        static_cast<size_t>(audio_length_samples))
-      break;
-    vector<float> chunk(&input_wav[j], &input_wav[j] + window_size_samples);
-    predict(chunk);
+  for (; pos + window <= new_samples.size(); pos += window) {
+    predict(new_samples.subspan(pos, window));
+  }
+
+  _pending.assign(new_samples.begin() + pos, new_samples.end());
+}
+
+// Sizes the batch buffers for the given number of lanes.
+void VadIterator::reserve_batch(int lanes) {
+  if (_batch_lanes == lanes)
+    return;
+  _batch_lanes = lanes;
+  _batch_input.assign(static_cast<size_t>(lanes) * effective_window_size,
+                      0.0f);
+  for (auto &state : _batch_state)
+    state.assign(2 * static_cast<size_t>(lanes) * 128, 0.0f);
+  _batch_prob.assign(lanes, 0.0f);
+
+  // One binding per state parity: step k reads _batch_state[k % 2] and
+  // writes the other one.
+  const int64_t input_dims[2] = {lanes, effective_window_size};
+  const int64_t state_dims[3] = {2, lanes, 128};
+  const int64_t prob_dims[2] = {lanes, 1};
+  for (int parity = 0; parity < 2; ++parity) {
+    auto &state_in = _batch_state[parity];
+    auto &state_out = _batch_state[1 - parity];
+    auto &inputs = _batch_inputs[parity];
+    auto &outputs = _batch_outputs[parity];
+    inputs.clear();
+    inputs.emplace_back(Ort::Value::CreateTensor<float>(
+        memory_info, _batch_input.data(), _batch_input.size(), input_dims, 2));
+    inputs.emplace_back(Ort::Value::CreateTensor<float>(
+        memory_info, state_in.data(), state_in.size(), state_dims, 3));
+    inputs.emplace_back(Ort::Value::CreateTensor<int64_t>(
+        memory_info, sr.data(), sr.size(), sr_node_dims, 1));
+    outputs.clear();
+    outputs.emplace_back(Ort::Value::CreateTensor<float>(
+        memory_info, _batch_prob.data(), _batch_prob.size(), prob_dims, 2));
+    outputs.emplace_back(Ort::Value::CreateTensor<float>(
+        memory_info, state_out.data(), state_out.size(), state_dims, 3));
+  }
+}
+
+// Batched mode: the windows of this call are split into `lanes` contiguous
+// runs that advance in lock step, one Session::Run per step. The LSTM state
+// chains windows, so lanes cannot simply be independent windows; lane 0
+// continues the current state and every other lane starts from zero state
+// a few windows early. The probabilities are then fed through the state
+// machine in order, so callbacks fire exactly as in process_stream().
+void VadIterator::process_stream_batched(span<const float> new_samples,
+                                         int lanes) {
+  speeches.clear();
+  const auto window = static_cast<size_t>(window_size_samples);
+  size_t pos = fill_pending(new_samples);
+  if (!_pending.empty())
+    return;
+
+  const float *base = new_samples.data() + pos;
+  const int windows = static_cast<int>((new_samples.size() - pos) / window);
+  lanes = min(lanes, windows / batch_min_lane_windows);
+  if (lanes < 2) {
+    for (int w = 0; w < windows; ++w)
+      predict({base + w * window, window});
+    _pending.assign(base + windows * window,
+                    new_samples.data() + new_samples.size());
+    return;
+  }
+  reserve_batch(lanes);
+
+  // Lane l covers windows [begin[l], begin[l + 1]) and starts running at
+  // first[l], batch_warmup_windows before its range (lane 0 at once).
+  vector<int> begin(lanes + 1), first(lanes);
+  for (int l = 0; l <= lanes; ++l)
+    begin[l] = static_cast<int>(static_cast<int64_t>(windows) * l / lanes);
+  int steps = 0;
+  for (int l = 0; l < lanes; ++l) {
+    first[l] = l == 0 ? 0 : begin[l] - batch_warmup_windows;
+    steps = max(steps, begin[l + 1] - first[l]);
+  }
+
+  _window_prob.resize(windows);
+  fill(_batch_state[0].begin(), _batch_state[0].end(), 0.0f);
+  // Lane 0 continues from the streaming state: [2, 1, 128] -> rows of lane 0.
+  copy(_state.begin(), _state.begin() + 128, _batch_state[0].begin());
+  copy(_state.begin() + 128, _state.end(),
+       _batch_state[0].begin() + static_cast<size_t>(lanes) * 128);
+
+  const size_t lane_state = static_cast<size_t>(lanes) * 128;
+
+  const auto started = chrono::steady_clock::now();
+  for (int step = 0; step < steps; ++step) {
+    auto &state_in = _batch_state[step % 2];
+    auto &state_out = _batch_state[(step + 1) % 2];
+
+    for (int l = 0; l < lanes; ++l) {
+      float *row = _batch_input.data() + l * effective_window_size;
+      const int w = first[l] + step;
+      if (w >= begin[l + 1]) {
+        fill(row, row + effective_window_size, 0.0f);
+        continue;
+      }
+      // The context of a window is the tail of the window before it.
+      if (w == 0) {
+        copy(_context.begin(), _context.end(), row);
+      } else {
+        const float *prev = base + w * window - context_samples;
+        copy(prev, prev + context_samples, row);
+      }
+      const float *chunk = base + w * window;
+      copy(chunk, chunk + window, row + context_samples);
+      // Zero-state warm-up lanes start here.
+      if (l > 0 && w == first[l]) {
+        fill_n(state_in.begin() + l * 128, 128, 0.0f);
+        fill_n(state_in.begin() + lane_state + l * 128, 128, 0.0f);
+      }
+    }
+
+    const auto &inputs = _batch_inputs[step % 2];
+    auto &outputs = _batch_outputs[step % 2];
+    session->Run(Ort::RunOptions{nullptr}, input_node_names.data(),
+                 inputs.data(), inputs.size(), output_node_names.data(),
+                 outputs.data(), outputs.size());
+
+    for (int l = 0; l < lanes; ++l) {
+      const int w = first[l] + step;
+      if (w >= begin[l] && w < begin[l + 1])
+        _window_prob[w] = _batch_prob[l];
+    }
+    // The last lane carries the state on to the next call.
+    const int last = lanes - 1;
+    if (first[last] + step == windows - 1) {
+      copy_n(state_out.begin() + last * 128, 128, _state.begin());
+      copy_n(state_out.begin() + lane_state + last * 128, 128,
+             _state.begin() + 128);
+    }
   }
+
+  // Recorded as the average over the windows of this call.
+  _inference_metric->record((chrono::steady_clock::now() - started) / windows);
+
+  const float *tail = base + windows * window - context_samples;
+  copy(tail, tail + context_samples, _context.begin());
+
+  for (int w = 0; w < windows; ++w)
+    update(_window_prob[w]);
+
+  _pending.assign(base + windows * window,
+                  new_samples.data() + new_samples.size());
+}
+
+// Batched counterpart of process().
+void VadIterator::process_batch(const vector<float> &input_wav, int lanes) {
+  reset_states();
+  audio_length_samples = static_cast<int>(input_wav.size());
+  process_stream_batched(input_wav, lanes);
+  flush_stream();
+}
+
+// Closes the open speech segment, if any, at the current position.
+void VadIterator::flush_stream() {
   if (current_speech.start >= 0) {
-    current_speech.end = audio_length_samples;
-    speeches.push_back(current_speech);
+    current_speech.end = get_current_sample();
+    emit_speech(current_speech);
     current_speech = timestamp_t();
     prev_end = 0;
     next_start = 0;
@@ -184,14 +393,21 @@ VadIterator::VadIterator(const string ModelPath, int Sample_rate,
       window_size_samples + context_samples; // e.g., 512 + 64 = 576 samples
   input_node_dims[0] = 1;
   input_node_dims[1] = effective_window_size;
+  input.assign(effective_window_size, 0.0f);
   _state.resize(size_state);
+  _stateN.resize(size_state);
+  _output.resize(1);
   sr.resize(1);
   sr[0] = sample_rate;
   _context.assign(context_samples, 0.0f);
+  _pending.reserve(window_size_samples);
+  // streaming calls clear speeches but keep its capacity
+  speeches.reserve(16);
   min_speech_samples = sr_per_ms * min_speech_duration_ms;
   max_speech_samples = (sample_rate * max_speech_duration_s -
                         window_size_samples - 2 * speech_pad_samples);
   min_silence_samples = sr_per_ms * min_silence_duration_ms;
   min_silence_samples_at_max_speech = sr_per_ms * 98;
   init_onnx_model(ModelPath);
+  bind_tensors();
 }
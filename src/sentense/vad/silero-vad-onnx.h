@@ -1,13 +1,17 @@
 #pragma once
 
+#include <chrono>
 #include <cmath> // for rint
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
+#include "metrics.h"
 #include "onnxruntime_cxx_api.h"
 
 using namespace std;
@@ -84,10 +88,13 @@ private:
   vector<float> input;
   unsigned int size_state = 2 * 1 * 128;
   vector<float> _state;
+  vector<float> _stateN; // model writes the next state here
+  vector<float> _output; // speech probability of the last window
   vector<int64_t> sr;
   int64_t input_node_dims[2] = {};
   const int64_t state_node_dims[3] = {2, 1, 128};
   const int64_t sr_node_dims[1] = {1};
+  const int64_t output_node_dims[2] = {1, 1};
   vector<Ort::Value> ort_outputs;
   vector<const char *> output_node_names = {"output", "stateN"};
 
@@ -110,6 +117,29 @@ private:
   vector<timestamp_t> speeches;
   timestamp_t current_speech;
 
+  // Streaming mode: trailing samples that did not fill a whole window yet.
+  vector<float> _pending;
+
+  // Batched mode: one row per lane, reused across calls.
+  int _batch_lanes = 0;
+  vector<float> _batch_input;    // [lanes, effective_window_size]
+  vector<float> _batch_state[2]; // [2, lanes, 128], double-buffered
+  vector<float> _batch_prob;     // [lanes, 1]
+  vector<float> _window_prob;    // one probability per window of the call
+  // Tensors bound to the buffers above, one set per state parity.
+  vector<Ort::Value> _batch_inputs[2];
+  vector<Ort::Value> _batch_outputs[2];
+
+  // Shared by every instance: windows evaluated and model time per window.
+  Counter *_windows_metric = &Metrics::instance().counter("vad.windows");
+  Histogram *_inference_metric =
+      &Metrics::instance().histogram("vad.inference");
+
+  // Windows of zero-state warm-up run before a lane's first real window.
+  static constexpr int batch_warmup_windows = 16;
+  // Lanes shorter than this are not worth splitting off.
+  static constexpr int batch_min_lane_windows = 32;
+
   // Loads the ONNX model.
   void init_onnx_model(const string &model_path);
 
@@ -121,7 +151,27 @@ private:
 
   // Inference: runs inference on one chunk of input data.
   // data_chunk is expected to have window_size_samples samples.
-  void predict(const vector<float> &data_chunk);
+  void predict(span<const float> data_chunk);
+
+  // Binds ort_inputs/ort_outputs to the preallocated buffers.
+  void bind_tensors();
+
+  // Runs the model on one window, carrying the LSTM state and context over.
+  // Returns the speech probability.
+  float infer(span<const float> data_chunk);
+
+  // Advances the segment state machine by one window.
+  void update(float speech_prob);
+
+  // Completes a window split across calls from _pending. Returns the number
+  // of samples taken from new_samples.
+  size_t fill_pending(span<const float> new_samples);
+
+  // Sizes the batch buffers for the given number of lanes.
+  void reserve_batch(int lanes);
+
+  // Records a closed speech segment and notifies on_speech_end.
+  void emit_speech(const timestamp_t &speech);
 
 public:
   // Constructor: sets model path, sample rate, window size (ms), and other
@@ -132,11 +182,49 @@ public:
               int min_speech_duration_ms = 250,
               float max_speech_duration_s = numeric_limits<float>::infinity());
 
+  // Streaming callbacks, fired as segment boundaries are detected. Sample
+  // positions count from the last reset().
+  function<void(int start)> on_speech_start;
+  function<void(const timestamp_t &speech)> on_speech_end;
+
   // Process the entire audio input.
   void process(const vector<float> &input_wav);
 
+  // Streaming mode: consumes only newly captured samples, keeping the LSTM
+  // state, context and trigger state across calls. Segments closed by this
+  // call are left in get_speech_timestamps() until the next call.
+  void process_stream(span<const float> new_samples);
+
+  // Same as process_stream(), but evaluates the model over up to `lanes`
+  // runs of windows per Session::Run. Each lane after the first starts from
+  // a zero LSTM state and is warmed up on the preceding audio, so
+  // probabilities may differ slightly from the per-window path near lane
+  // boundaries. Falls back to per-window inference for short inputs.
+  void process_stream_batched(span<const float> new_samples, int lanes = 8);
+
+  // Batched counterpart of process().
+  void process_batch(const vector<float> &input_wav, int lanes = 8);
+
+  // Closes the open speech segment, if any, at the current position.
+  void flush_stream();
+
   // Returns the detected speech timestamps.
-  const vector<timestamp_t> get_speech_timestamps() const { return speeches; }
+  const vector<timestamp_t> &get_speech_timestamps() const { return speeches; }
+
+  bool is_triggered() const { return triggered; }
+
+  // Start of the speech segment still open, or -1.
+  int get_speech_start() const { return current_speech.start; }
+
+  // Samples consumed since the last reset(), including pending ones.
+  int get_current_sample() const {
+    return static_cast<int>(current_sample + _pending.size());
+  }
+
+  // Samples run through the model since the last reset(). Samples still
+  // waiting in _pending are not included, and the next segment cannot
+  // start before this position.
+  int get_processed_sample() const { return static_cast<int>(current_sample); }
 
   // Public method to reset the internal state.
   void reset() { reset_states(); }
@@ -0,0 +1,53 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Input audio shared by vad_test and vad_bench.
+
+// Reads the data chunk of a 16-bit PCM WAV file. The format is not checked:
+// the file must already be 16 kHz mono.
+inline auto read_wav(const std::string &path, std::vector<float> &out)
+    -> bool {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+
+  char riff[12];
+  file.read(riff, sizeof(riff));
+  if (std::string(riff, 4) != "RIFF" || std::string(riff + 8, 4) != "WAVE")
+    return false;
+
+  // Skip chunks until "data"
+  char id[4];
+  uint32_t size = 0;
+  while (file.read(id, 4) && file.read(reinterpret_cast<char *>(&size), 4)) {
+    if (std::string(id, 4) == "data") {
+      std::vector<int16_t> pcm(size / sizeof(int16_t));
+      file.read(reinterpret_cast<char *>(pcm.data()), size);
+      out.resize(pcm.size());
+      for (size_t i = 0; i < pcm.size(); ++i)
+        out[i] = static_cast<float>(pcm[i]) / 32768.0f;
+      return true;
+    }
+    file.seekg(size, std::ios::cur);
+  }
+  return false;
+}
+
+// Noise with 2 s tone bursts every 5 s.
+inline auto synth(int sample_rate, int seconds, unsigned seed)
+    -> std::vector<float> {
+  std::vector<float> out(static_cast<size_t>(sample_rate) * seconds);
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0.0f, 0.01f);
+  for (size_t i = 0; i < out.size(); ++i) {
+    const float t = static_cast<float>(i) / sample_rate;
+    const bool on = static_cast<int>(t) % 5 < 2;
+    out[i] = noise(rng) + (on ? 0.3f * sinf(2.0f * M_PI * 220.0f * t) : 0.0f);
+  }
+  return out;
+}
@@ -0,0 +1,145 @@
+#include "silero-vad-onnx.h"
+#include "test-audio.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Checks that the streaming VAD hot path does not heap-allocate per window.
+//
+//   vad_test <model.onnx> [input.wav]
+//
+// input.wav must be 16 kHz mono 16-bit PCM. Without it ten minutes of
+// synthetic audio are used. ONNX Runtime may allocate inside Session::Run;
+// that cost is measured on a bare session with preallocated tensors and
+// allowed as the baseline.
+
+namespace {
+
+std::atomic<bool> g_counting{false};
+std::atomic<size_t> g_allocs{0};
+
+} // namespace
+
+auto operator new(size_t size) -> void * {
+  if (g_counting.load(std::memory_order_relaxed))
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+auto operator new[](size_t size) -> void * { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Allocations of one Session::Run with every tensor preallocated.
+auto baseline_allocs_per_run(const string &model_path, int runs) -> double {
+  Ort::Env env;
+  Ort::SessionOptions options;
+  options.SetIntraOpNumThreads(1);
+  options.SetInterOpNumThreads(1);
+  options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+  Ort::Session session(env, model_path.c_str(), options);
+  auto memory_info =
+      Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeCPU);
+
+  vector<float> input(576), state(256), state_n(256), prob(1);
+  vector<int64_t> sr{16000};
+  const int64_t input_dims[2] = {1, 576};
+  const int64_t state_dims[3] = {2, 1, 128};
+  const int64_t sr_dims[1] = {1};
+  const int64_t prob_dims[2] = {1, 1};
+  const char *input_names[] = {"input", "state", "sr"};
+  const char *output_names[] = {"output", "stateN"};
+
+  vector<Ort::Value> inputs;
+  inputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, input.data(), input.size(), input_dims, 2));
+  inputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, state.data(), state.size(), state_dims, 3));
+  inputs.emplace_back(Ort::Value::CreateTensor<int64_t>(
+      memory_info, sr.data(), sr.size(), sr_dims, 1));
+  vector<Ort::Value> outputs;
+  outputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, prob.data(), prob.size(), prob_dims, 2));
+  outputs.emplace_back(Ort::Value::CreateTensor<float>(
+      memory_info, state_n.data(), state_n.size(), state_dims, 3));
+
+  auto run = [&] {
+    session.Run(Ort::RunOptions{nullptr}, input_names, inputs.data(),
+                inputs.size(), output_names, outputs.data(), outputs.size());
+  };
+  for (int i = 0; i < 100; ++i)
+    run();
+
+  g_allocs = 0;
+  g_counting = true;
+  for (int i = 0; i < runs; ++i)
+    run();
+  g_counting = false;
+  return static_cast<double>(g_allocs) / runs;
+}
+
+} // namespace
+
+auto main(int argc, char **argv) -> int {
+  if (argc < 2) {
+    cerr << "usage: " << argv[0] << " <model.onnx> [input.wav]\n";
+    return 1;
+  }
+  const int sample_rate = 16000;
+  const size_t window = 512;
+  const size_t block = sample_rate / 10; // 100 ms, not a window multiple
+
+  vector<float> wav;
+  if (argc > 2 && !read_wav(argv[2], wav)) {
+    cerr << "failed to read " << argv[2] << '\n';
+    return 1;
+  }
+  if (wav.empty())
+    wav = synth(sample_rate, 600, 7);
+  const size_t windows = wav.size() / window;
+
+  VadIterator vad(argv[1], sample_rate, 32, 0.5, 500);
+  size_t segments = 0;
+  vad.on_speech_end = [&](const timestamp_t &) { ++segments; };
+
+  // Warm up: the first runs let ORT size its arenas.
+  const span<const float> audio(wav);
+  vad.process_stream(audio.first(min(audio.size(), window * 100)));
+  vad.reset();
+  segments = 0;
+
+  g_allocs = 0;
+  g_counting = true;
+  for (size_t pos = 0; pos < wav.size(); pos += block) {
+    vad.process_stream(audio.subspan(pos, min(block, audio.size() - pos)));
+  }
+  g_counting = false;
+  const size_t vad_allocs = g_allocs;
+  vad.flush_stream();
+
+  const double baseline = baseline_allocs_per_run(argv[1], 1000);
+  // Closed segments may grow the speeches vector.
+  const double budget = baseline * static_cast<double>(windows) + segments;
+
+  cout << "windows:           " << windows << '\n';
+  cout << "segments:          " << segments << '\n';
+  cout << "ORT baseline/run:  " << baseline << '\n';
+  cout << "VadIterator total: " << vad_allocs << " ("
+       << static_cast<double>(vad_allocs) / windows << "/window)\n";
+
+  if (static_cast<double>(vad_allocs) > budget) {
+    cout << "FAIL: " << vad_allocs << " allocations, budget " << budget
+         << '\n';
+    return 1;
+  }
+  cout << "PASS\n";
+  return 0;
+}
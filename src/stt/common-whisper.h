@@ -6,11 +6,11 @@
 
 using namespace std;
 
-// Read WAV audio file and store the PCM data into pcmf32
+// Decode an audio file with decode_audio() and store the PCM data, converted
+// to WHISPER_SAMPLE_RATE, into pcmf32
 // fname can be a buffer of WAV data instead of a filename
-// The sample rate of the audio must be equal to COMMON_SAMPLE_RATE
-// If stereo flag is set and the audio has 2 channels, the pcmf32s will contain
-// 2 channel PCM
+// If stereo flag is set, pcmf32 is interleaved and pcmf32s will contain the
+// 2 channels
 auto read_audio_data(const string &fname, vector<float> &pcmf32,
                      vector<vector<float>> &pcmf32s, bool stereo) -> bool;
 
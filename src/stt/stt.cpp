@@ -2,7 +2,7 @@
 #include "common-whisper.h"
 
 #include "events.h"
-#include <deque>
+#include <algorithm>
 #include <print>
 #include <spdlog/common.h>
 #include <spdlog/spdlog.h>
@@ -13,16 +13,19 @@
 
 STT::STT(whisper_context_params &cparams, whisper_full_params &wparams,
          string path_model, string language, bool no_context,
-         std::shared_ptr<EventBus> bus)
+         std::shared_ptr<EventBus> bus, STTPartialParams partial,
+         int n_workers)
     : stopInference(false), cparams(cparams), path_model(std::move(path_model)),
       language(std::move(language)), wparams(wparams), no_context(no_context),
-      eventBus(std::move(bus)) {
+      eventBus(std::move(bus)), partialParams(partial) {
 
   // wparams.language is just a pointer!
   this->wparams.language = this->language.c_str();
   spdlog::info("STT: wparams.language is {}", this->wparams.language);
-  ctx = whisper_init_from_file_with_params(this->path_model.c_str(),
-                                           this->cparams);
+  // The model is loaded once; every worker and the partial hypotheses get
+  // their own whisper_state on top of it.
+  ctx = whisper_init_from_file_with_params_no_state(this->path_model.c_str(),
+                                                    this->cparams);
 
   if (!whisper_is_multilingual(ctx)) {
     if (this->language != "en" || this->wparams.translate) {
@@ -35,29 +38,59 @@ STT::STT(whisper_context_params &cparams, whisper_full_params &wparams,
     }
   }
 
+  // Each result is used as the prompt of the next one unless no_context is
+  // set, which serializes transcription on a single worker.
+  if (!no_context && n_workers > 1) {
+    spdlog::warn("STT: context is enabled, using 1 worker instead of {}",
+                 n_workers);
+    n_workers = 1;
+  }
+  n_workers = max(n_workers, 1);
+  this->wparams.n_threads = max(1, this->wparams.n_threads / n_workers);
+  pool = make_unique<WhisperPool>(
+      ctx, n_workers,
+      [this](whisper_state *state, span<const float> pcmf32, int stream_id) {
+        return inference(state, pcmf32, stream_id);
+      },
+      [this](string text, int stream_id, Trace trace) {
+        eventBus->publish<MessageAddedEvent>("stt", std::move(text),
+                                             stream_id, trace);
+      });
+
+  // Partial hypotheses run on their own whisper_state so they never touch
+  // the state used for final transcription. They are throwaway: a single
+  // segment, no prompt, no context.
+  partialWparams = this->wparams;
+  partialWparams.single_segment = true;
+  partialWparams.no_context = true;
+  partialWparams.prompt_tokens = nullptr;
+  partialWparams.prompt_n_tokens = 0;
+  partialWparams.print_timestamps = false;
+  if (partialParams.step_samples > 0) {
+    partialState = whisper_init_state(ctx);
+    partialWindow.reserve(partialParams.length_samples);
+  }
+
   eventBus->subscribe<StartServiceEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto startEvent = std::static_pointer_cast<StartServiceEvent>(event);
-        if (startEvent->serviceName == "stt") {
+      [this](const StartServiceEvent &startEvent) {
+        if (startEvent.serviceName == "stt") {
           start();
           eventBus->publish<ServiceStatusEvent>("stt", true);
         }
       });
 
   eventBus->subscribe<StopServiceEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto stopEvent = std::static_pointer_cast<StopServiceEvent>(event);
-        if (stopEvent->serviceName == "stt") {
+      [this](const StopServiceEvent &stopEvent) {
+        if (stopEvent.serviceName == "stt") {
           stop();
           eventBus->publish<ServiceStatusEvent>("stt", false);
         }
       });
 
   eventBus->subscribe<AutoModeSetEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto autoModeEvent = std::static_pointer_cast<AutoModeSetEvent>(event);
-        if (autoModeEvent->serviceName == "stt") {
-          if (autoModeEvent->isAutoMode) {
+      [this](const AutoModeSetEvent &autoModeEvent) {
+        if (autoModeEvent.serviceName == "stt") {
+          if (autoModeEvent.isAutoMode) {
             setTriggerMethod(TriggerMethod::AUTO_TRIGGER);
           } else {
             setTriggerMethod(TriggerMethod::NO_TRIGGER);
@@ -65,50 +98,87 @@ STT::STT(whisper_context_params &cparams, whisper_full_params &wparams,
         }
       });
 
+  // Audio events come from the capture thread and the GUI. Run them in
+  // order on one worker so publishers never wait for the queue locks.
+  audioExecutor = std::make_shared<WorkerExecutor>(256, Overflow::Block);
+
+  // Counted on the publisher's thread, so that idle() also sees sentences
+  // still waiting in audioExecutor.
   eventBus->subscribe<AudioAddedEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto audioEvent = std::static_pointer_cast<AudioAddedEvent>(event);
-        auto audio = audioEvent->audio;
-        addVoice(audio);
-      });
+      [this](const AudioAddedEvent &) { incoming++; });
+  eventBus->subscribe<AudioAddedEvent>(
+      [this](const AudioAddedEvent &audioEvent) {
+        addVoice(audioEvent.audio, audioEvent.stream_id, audioEvent.id);
+        resetPartial(audioEvent.stream_id);
+        incoming--;
+      },
+      audioExecutor);
+
+  if (partialState != nullptr) {
+    eventBus->subscribe<AudioPartialEvent>(
+        [this](const AudioPartialEvent &audioEvent) {
+          addPartial(audioEvent.audio, audioEvent.stream_id);
+        },
+        audioExecutor);
+  }
 
   eventBus->subscribe<AudioRemovedEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto audioEvent = std::static_pointer_cast<AudioRemovedEvent>(event);
-        removeVoice(audioEvent->index);
-      });
+      [this](const AudioRemovedEvent &audioEvent) {
+        removeVoice(audioEvent.id);
+      },
+      audioExecutor);
+
+  eventBus->subscribe<AudioMovedEvent>(
+      [this](const AudioMovedEvent &audioEvent) {
+        moveVoice(audioEvent.id, audioEvent.before_id);
+      },
+      audioExecutor);
 
   eventBus->subscribe<AudioClearedEvent>(
-      [this](const std::shared_ptr<Event> &event) { clearVoice(); });
+      [this](const AudioClearedEvent &) { clearVoice(); }, audioExecutor);
 
   eventBus->subscribe<AudioSentEvent>(
-      [this](const std::shared_ptr<Event> &event) {
+      [this](const AudioSentEvent &) {
         setTriggerMethod(TriggerMethod::ONCE_TRIGGER);
-      });
+      },
+      audioExecutor);
 }
 
 STT::~STT() {
+  audioExecutor->stop();
+  pool.reset();
+  if (partialState != nullptr) {
+    whisper_free_state(partialState);
+  }
   whisper_print_timings(ctx);
   whisper_free(ctx);
 }
 
 auto STT::getQueueSizes() const -> vector<size_t> {
   lock_guard<mutex> lock(queueMutex);
-  vector<size_t> sizes;
-  queue<vector<float>> tempQueue = voiceQueue;
+  return voiceQueue.sizes();
+}
 
-  while (!tempQueue.empty()) {
-    sizes.push_back(tempQueue.front().size());
-    tempQueue.pop();
+void STT::start() {
+  pool->start();
+  processThread = thread(&STT::processVoices, this);
+  if (partialState != nullptr) {
+    partialThread = thread(&STT::processPartials, this);
   }
-  return sizes;
 }
 
-void STT::start() { processThread = thread(&STT::processVoices, this); }
-
 void STT::processVoices() {
   while (true) {
-    vector<float> mergedVoice;
+    // Queued sentences of each stream, in order of first appearance. The
+    // merged sentence is traced under the ID of its first one.
+    struct Merged {
+      int stream_id;
+      uint64_t trace_id;
+      vector<AudioChunk> voices;
+    };
+    vector<Merged> mergedVoices;
+    // Sent sentences, when they are transcribed one by one
+    vector<VoiceQueue::Voice> speculated;
 
     {
       unique_lock<mutex> lock(queueMutex);
@@ -127,11 +197,32 @@ void STT::processVoices() {
         continue;
       }
 
-      // Merge all available voices in the queue
-      while (!voiceQueue.empty()) {
-        vector<float> &voice = voiceQueue.front();
-        mergedVoice.insert(mergedVoice.end(), voice.begin(), voice.end());
-        voiceQueue.pop();
+      auto voices = voiceQueue.takeAll();
+      queueMetric.set(0);
+      sending = true;
+      const auto taken = Tracer::Clock::now();
+      for (const auto &voice : voices) {
+        Tracer::instance().record("stt.queue", voice.id, voice.queued, taken,
+                                  voice.stream_id);
+      }
+
+      if (speculative) {
+        // They were transcribed one by one, texts are merged instead
+        speculated = std::move(voices);
+      } else {
+        // Merge all available voices in the queue, keeping each stream apart
+        for (auto &voice : voices) {
+          auto it = find_if(
+              mergedVoices.begin(), mergedVoices.end(),
+              [&voice](const auto &merged) {
+                return merged.stream_id == voice.stream_id;
+              });
+          if (it == mergedVoices.end()) {
+            mergedVoices.push_back({voice.stream_id, voice.id, {}});
+            it = prev(mergedVoices.end());
+          }
+          it->voices.push_back(std::move(voice.audio));
+        }
       }
 
       if (triggerMethod == ONCE_TRIGGER) {
@@ -145,73 +236,201 @@ void STT::processVoices() {
     //   callbacks.onVoiceCleared();
     // }
 
-    if (!mergedVoice.empty()) {
-      string text = inference(mergedVoice);
-      eventBus->publish<MessageAddedEvent>("stt", text);
-    } else {
-      spdlog::error("{}: {}", __func__, "no voice data after merge");
+    if (!speculated.empty()) {
+      sendSpeculated(std::move(speculated));
+    }
+
+    for (auto &[stream_id, trace_id, voices] : mergedVoices) {
+      // A single sentence is passed on as is; only several are copied
+      // into one buffer, since whisper_full needs contiguous audio.
+      AudioChunk mergedVoice = AudioChunk::concat(voices);
+      if (!mergedVoice.empty()) {
+        // Results are published in submission order by the pool.
+        pool->submit(std::move(mergedVoice), stream_id, trace_id);
+      } else {
+        spdlog::error("{}: {}", __func__, "no voice data after merge");
+      }
     }
+
+    lock_guard<mutex> lock(queueMutex);
+    sending = false;
   }
 }
 
-void STT::addVoice(vector<float> voice_data) {
+// A sentence is counted by each stage until the next one has it, so checking
+// from upstream to downstream cannot miss one in between.
+auto STT::idle() const -> bool {
+  if (incoming.load() != 0) {
+    return false;
+  }
   {
     lock_guard<mutex> lock(queueMutex);
-    voiceQueue.push(voice_data);
+    if (!voiceQueue.empty() || sending) {
+      return false;
+    }
+  }
+  return pool->pending() == 0;
+}
+
+void STT::addVoice(AudioChunk voice_data, int stream_id, uint64_t id) {
+  bool speculate = false;
+  {
+    lock_guard<mutex> lock(queueMutex);
+    if (!voiceQueue.push({id, voice_data, stream_id, Tracer::Clock::now()})) {
+      return;
+    }
+    queueMetric.set(static_cast<double>(voiceQueue.size()));
+    // In auto mode the sentence is about to be sent anyway.
+    speculate = speculative && triggerMethod == NO_TRIGGER &&
+                speculations.try_emplace(id).second;
   }
   cv.notify_one();
+  if (speculate) {
+    this->speculate(id, std::move(voice_data), stream_id);
+  }
   // if (callbacks.onVoiceAdded) {
   //   callbacks.onVoiceAdded(std::to_string(voice_data.size()));
   // }
 }
 
+void STT::setSpeculative(bool enabled) {
+  lock_guard<mutex> lock(queueMutex);
+  speculative = enabled;
+}
+
+// The pool is never submitted to under queueMutex: its workers take
+// queueMutex while delivering, so that would invert the lock order.
+void STT::speculate(uint64_t id, AudioChunk voice_data, int stream_id) {
+  pool->submit(std::move(voice_data), stream_id, id,
+               [this, id](string text, int, Trace) {
+                 {
+                   lock_guard<mutex> lock(queueMutex);
+                   auto it = speculations.find(id);
+                   if (it == speculations.end()) {
+                     return; // removed or cleared meanwhile
+                   }
+                   it->second.done = true;
+                   it->second.text = std::move(text);
+                 }
+                 speculationCv.notify_all();
+               });
+}
+
+// Sentences that were already transcribed cost nothing here; the rest are
+// submitted now, in parallel when the pool has several workers. The texts
+// of each stream are then published as one message, in queue order.
+void STT::sendSpeculated(vector<VoiceQueue::Voice> voices) {
+  vector<VoiceQueue::Voice> missing;
+  {
+    lock_guard<mutex> lock(queueMutex);
+    for (const auto &voice : voices) {
+      if (speculations.try_emplace(voice.id).second) {
+        missing.push_back(voice);
+      }
+    }
+  }
+  spdlog::info("STT: sending {} sentences, {} not speculated", voices.size(),
+               missing.size());
+  for (auto &voice : missing) {
+    speculate(voice.id, std::move(voice.audio), voice.stream_id);
+  }
+
+  // Texts of each stream in order of first appearance, traced under the
+  // first sentence
+  struct Merged {
+    int stream_id;
+    string text;
+    Trace trace;
+  };
+  vector<Merged> texts;
+  {
+    unique_lock<mutex> lock(queueMutex);
+    speculationCv.wait(lock, [this, &voices]() {
+      return stopInference ||
+             all_of(voices.begin(), voices.end(), [this](const auto &voice) {
+               auto it = speculations.find(voice.id);
+               return it == speculations.end() || it->second.done;
+             });
+    });
+    if (stopInference) {
+      return;
+    }
+
+    for (const auto &voice : voices) {
+      auto node = speculations.extract(voice.id);
+      if (node.empty() || node.mapped().text.empty()) {
+        continue;
+      }
+      auto it = find_if(texts.begin(), texts.end(), [&voice](const auto &t) {
+        return t.stream_id == voice.stream_id;
+      });
+      if (it == texts.end()) {
+        texts.push_back({voice.stream_id, std::move(node.mapped().text),
+                         {voice.id, voice.audio.captured_at()}});
+      } else {
+        it->text += "," + node.mapped().text;
+      }
+    }
+  }
+
+  for (auto &[stream_id, text, trace] : texts) {
+    eventBus->publish<MessageAddedEvent>("stt", std::move(text), stream_id,
+                                         trace);
+  }
+}
+
 void STT::stop() {
   {
     lock_guard<mutex> lock(queueMutex);
     stopInference = true;
   }
   cv.notify_all();
+  speculationCv.notify_all();
   processThread.join();
+  pool->stop();
+  {
+    // the pool dropped the jobs they were waiting for
+    lock_guard<mutex> lock(queueMutex);
+    speculations.clear();
+  }
+
+  if (partialThread.joinable()) {
+    {
+      lock_guard<mutex> lock(partialMutex);
+      stopPartial = true;
+    }
+    partialCv.notify_all();
+    partialThread.join();
+  }
 }
 
 void STT::clearVoice() {
   {
     lock_guard<mutex> lock(queueMutex);
-    queue<vector<float>> empty;
-    swap(voiceQueue, empty);
+    // Only queued sentences: the ones being sent are still awaited.
+    for (const auto &voice : voiceQueue.takeAll()) {
+      speculations.erase(voice.id);
+    }
+    queueMetric.set(0);
   }
   // if (callbacks.onVoiceCleared) {
   //   callbacks.onVoiceCleared();
   // }
 }
 
-auto STT::removeVoice(size_t index) -> bool {
-  bool result = false;
-  {
-    lock_guard<mutex> lock(queueMutex);
-    if (index >= voiceQueue.size())
-      return false;
-
-    // Convert queue to deque for random access
-    deque<vector<float>> tempDeque;
-    while (!voiceQueue.empty()) {
-      tempDeque.push_back(voiceQueue.front());
-      voiceQueue.pop();
-    }
-
-    tempDeque.erase(tempDeque.begin() + index);
-    result = true;
-
-    // Convert back to queue
-    for (const auto &item : tempDeque) {
-      voiceQueue.push(item);
-    }
+auto STT::removeVoice(uint64_t id) -> bool {
+  lock_guard<mutex> lock(queueMutex);
+  if (!voiceQueue.remove(id)) {
+    return false;
   }
+  queueMetric.set(static_cast<double>(voiceQueue.size()));
+  speculations.erase(id);
+  return true;
+}
 
-  // if (result && callbacks.onVoiceRemoved) {
-  //   callbacks.onVoiceRemoved(index);
-  // }
-  return result;
+auto STT::moveVoice(uint64_t id, uint64_t before_id) -> bool {
+  lock_guard<mutex> lock(queueMutex);
+  return voiceQueue.move(id, before_id);
 }
 
 void STT::setTriggerMethod(TriggerMethod triggerMethod) {
@@ -222,35 +441,45 @@ void STT::setTriggerMethod(TriggerMethod triggerMethod) {
   cv.notify_one();
 }
 
-auto STT::inference(vector<float> pcmf32) -> string {
+auto STT::inference(whisper_state *state, span<const float> pcmf32,
+                    int stream_id) -> string {
   string result;
   spdlog::info("inference language is {}", language);
   spdlog::info("inference wparams.language is {}", wparams.language);
 
-  wparams.prompt_tokens = no_context ? nullptr : prompt_tokens.data();
-  wparams.prompt_n_tokens = no_context ? 0 : prompt_tokens.size();
-
-  if (whisper_full(ctx, wparams, pcmf32.data(), pcmf32.size()) != 0) {
+  // Workers share wparams, so the prompt goes into a per-call copy. Each
+  // stream is prompted with its own previous result. prompt_tokens is only
+  // touched with context enabled, which runs a single worker; workers
+  // running in parallel under no_context never access the map.
+  vector<whisper_token> *prompt =
+      no_context ? nullptr : &prompt_tokens[stream_id];
+  whisper_full_params params = wparams;
+  params.prompt_tokens = prompt ? prompt->data() : nullptr;
+  params.prompt_n_tokens = prompt ? prompt->size() : 0;
+
+  if (whisper_full_with_state(ctx, state, params, pcmf32.data(),
+                              pcmf32.size()) != 0) {
     return {};
   }
 
+  const int iter = n_iter++;
   {
-    const int n_segments = whisper_full_n_segments(ctx);
+    const int n_segments = whisper_full_n_segments_from_state(state);
     for (int i = 0; i < n_segments; ++i) {
-      const char *text = whisper_full_get_segment_text(ctx, i);
+      const char *text = whisper_full_get_segment_text_from_state(state, i);
 
       result += text;
       if (i != n_segments - 1) {
         result += ",";
       }
 
-      const int64_t t0 = whisper_full_get_segment_t0(ctx, i);
-      const int64_t t1 = whisper_full_get_segment_t1(ctx, i);
+      const int64_t t0 = whisper_full_get_segment_t0_from_state(state, i);
+      const int64_t t1 = whisper_full_get_segment_t1_from_state(state, i);
 
       string output = "[" + to_timestamp(t0, false) + " --> " +
                       to_timestamp(t1, false) + "]  " + text;
 
-      if (whisper_full_get_segment_speaker_turn_next(ctx, i)) {
+      if (whisper_full_get_segment_speaker_turn_next_from_state(state, i)) {
         output += " [SPEAKER_TURN]";
       }
 
@@ -258,19 +487,17 @@ auto STT::inference(vector<float> pcmf32) -> string {
       fflush(stdout);
     }
 
-    spdlog::info("### Transcription {} END", n_iter);
+    spdlog::info("### Transcription {} END", iter);
   }
 
-  ++n_iter;
+  if (prompt) {
+    prompt->clear();
 
-  if (!no_context) {
-    prompt_tokens.clear();
-
-    const int n_segments = whisper_full_n_segments(ctx);
+    const int n_segments = whisper_full_n_segments_from_state(state);
     for (int i = 0; i < n_segments; ++i) {
-      const int token_count = whisper_full_n_tokens(ctx, i);
+      const int token_count = whisper_full_n_tokens_from_state(state, i);
       for (int j = 0; j < token_count; ++j) {
-        prompt_tokens.push_back(whisper_full_get_token_id(ctx, i, j));
+        prompt->push_back(whisper_full_get_token_id_from_state(state, i, j));
       }
     }
   }
@@ -278,3 +505,111 @@ auto STT::inference(vector<float> pcmf32) -> string {
   fflush(stdout);
   return result;
 }
+
+// The window follows one stream at a time: the first one to speak after the
+// previous sentence was finalized.
+void STT::addPartial(const AudioChunk &voice_data, int stream_id) {
+  {
+    lock_guard<mutex> lock(partialMutex);
+    if (partialStream < 0) {
+      partialStream = stream_id;
+    }
+    if (stream_id != partialStream) {
+      return;
+    }
+    partialNew.insert(partialNew.end(), voice_data.begin(), voice_data.end());
+  }
+  partialCv.notify_one();
+}
+
+// The sentence was closed and queued for final transcription: drop the
+// window and clear the partial text.
+void STT::resetPartial(int stream_id) {
+  if (partialState == nullptr) {
+    return;
+  }
+  {
+    lock_guard<mutex> lock(partialMutex);
+    if (stream_id != partialStream) {
+      return;
+    }
+    partialStream = -1;
+    partialWindow.clear();
+    partialNew.clear();
+    partialCommitted.clear();
+    partialText.clear();
+    ++partialGeneration;
+  }
+  eventBus->publish<MessagePartialEvent>("stt", "", stream_id);
+}
+
+// Sliding window as in whisper.cpp's stream example: every step_samples of
+// new audio, transcribe the window. When the window would exceed
+// length_samples, its hypothesis is committed and only keep_samples of it
+// are carried over.
+void STT::processPartials() {
+  const size_t n_step = partialParams.step_samples;
+  const size_t n_len = max(partialParams.length_samples, 1);
+  const size_t n_keep = partialParams.keep_samples;
+
+  vector<float> window;
+  while (true) {
+    uint64_t generation = 0;
+    int stream_id = 0;
+    {
+      unique_lock<mutex> lock(partialMutex);
+      partialCv.wait(lock, [this, n_step]() {
+        return partialNew.size() >= n_step || stopPartial;
+      });
+      if (stopPartial) {
+        return;
+      }
+
+      if (partialWindow.size() + partialNew.size() > n_len) {
+        partialCommitted += partialText;
+        partialText.clear();
+        const size_t keep = min(n_keep, partialWindow.size());
+        partialWindow.erase(partialWindow.begin(), partialWindow.end() - keep);
+      }
+      partialWindow.insert(partialWindow.end(), partialNew.begin(),
+                           partialNew.end());
+      partialNew.clear();
+      if (partialWindow.size() > n_len) {
+        partialWindow.erase(partialWindow.begin(),
+                            partialWindow.end() - n_len);
+      }
+
+      window.assign(partialWindow.begin(), partialWindow.end());
+      generation = partialGeneration;
+      stream_id = partialStream;
+    }
+
+    string text = inferPartial(window);
+
+    string message;
+    {
+      lock_guard<mutex> lock(partialMutex);
+      // The sentence was finalized while whisper was running.
+      if (generation != partialGeneration) {
+        continue;
+      }
+      partialText = std::move(text);
+      message = partialCommitted + partialText;
+    }
+    eventBus->publish<MessagePartialEvent>("stt", message, stream_id);
+  }
+}
+
+auto STT::inferPartial(const vector<float> &pcmf32) -> string {
+  if (whisper_full_with_state(ctx, partialState, partialWparams, pcmf32.data(),
+                              pcmf32.size()) != 0) {
+    return {};
+  }
+
+  string result;
+  const int n_segments = whisper_full_n_segments_from_state(partialState);
+  for (int i = 0; i < n_segments; ++i) {
+    result += whisper_full_get_segment_text_from_state(partialState, i);
+  }
+  return result;
+}
@@ -1,57 +1,126 @@
 #pragma once
+#include "audiochunk.h"
 #include "eventbus.h"
+#include "metrics.h"
+#include "voice-queue.h"
+#include "whisper-pool.h"
+#include <atomic>
 #include <condition_variable>
+#include <map>
 #include <queue>
+#include <span>
+#include <unordered_map>
 #include <vector>
 #include <whisper.h>
 
 using namespace std;
 
+// Sliding window for partial hypotheses, in samples. Whisper runs every
+// step_samples over the last length_samples of the open sentence, keeping
+// keep_samples when the window rolls over. step_samples == 0 disables it.
+struct STTPartialParams {
+  int step_samples = 0;
+  int length_samples = 0;
+  int keep_samples = 0;
+};
+
 class STT {
 public:
   enum TriggerMethod { AUTO_TRIGGER = -1, NO_TRIGGER = 0, ONCE_TRIGGER = 1 };
 
   STT(whisper_context_params &cparams, whisper_full_params &wparams,
       string path_model, string language, bool no_context,
-      std::shared_ptr<EventBus> eventBus);
+      std::shared_ptr<EventBus> eventBus, STTPartialParams partial = {},
+      int n_workers = 1);
   ~STT();
 
+  // Transcribe each sentence queued in manual mode as soon as it arrives, so
+  // that sending only has to wait for sentences not finished yet.
+  void setSpeculative(bool enabled);
+
+  // No sentence is waiting for the audio handlers, queued, being submitted
+  // or waiting for its result. In manual mode queued sentences wait for a
+  // send, so this stays false.
+  [[nodiscard]] auto idle() const -> bool;
+
 private:
-  auto inference(vector<float> voice_data) -> string;
+  auto inference(whisper_state *state, span<const float> voice_data,
+                 int stream_id) -> string;
 
   void start();
   void stop();
 
   // Queue management functions
   auto getQueueSizes() const -> vector<size_t>;
-  void addVoice(vector<float> voice_data);
-  auto removeVoice(size_t index) -> bool;
+  void addVoice(AudioChunk voice_data, int stream_id, uint64_t id);
+  auto removeVoice(uint64_t id) -> bool;
+  auto moveVoice(uint64_t id, uint64_t before_id) -> bool;
   void clearVoice();
   void setTriggerMethod(TriggerMethod triggerMethod);
 
   void processVoices();
 
+  // Speculative transcription
+  struct Speculation {
+    bool done = false;
+    string text;
+  };
+  void speculate(uint64_t id, AudioChunk voice_data, int stream_id);
+  void sendSpeculated(vector<VoiceQueue::Voice> voices);
+
+  // Streaming partial hypotheses
+  void addPartial(const AudioChunk &voice_data, int stream_id);
+  void resetPartial(int stream_id);
+  void processPartials();
+  auto inferPartial(const vector<float> &pcmf32) -> string;
+
   std::shared_ptr<EventBus> eventBus;
+  std::shared_ptr<WorkerExecutor> audioExecutor; // Audio*Event handlers
+  // AudioAddedEvents published and not handled by audioExecutor yet
+  atomic<int64_t> incoming = 0;
 
   bool is_running = true;
 
-  queue<vector<float>> voiceQueue; // Message queue
+  VoiceQueue voiceQueue; // Sentences by ID
+  Gauge &queueMetric = Metrics::instance().gauge("stt.queue"); // its size
   bool stopInference;              // Whether to stop the voice system
   TriggerMethod triggerMethod = NO_TRIGGER;
+  bool sending = false; // taken from the queue, not submitted yet
 
   mutable mutex queueMutex; // Mutex to protect the message queue
   condition_variable cv;    // Condition variable for thread synchronization
 
+  bool speculative = false;
+  // Texts of queued and sending sentences by ID, guarded by queueMutex.
+  // Dropping an entry discards its result when it arrives.
+  unordered_map<uint64_t, Speculation> speculations;
+  condition_variable speculationCv; // a speculation finished
+
   thread processThread;
 
   whisper_full_params wparams;
   string language;
   string path_model;
-  int n_iter = 0;
+  atomic<int> n_iter = 0;
   whisper_context_params cparams;
   whisper_context *ctx;
+  unique_ptr<WhisperPool> pool; // final transcription, one state per worker
 
   bool no_context = false;
 
-  vector<whisper_token> prompt_tokens;
+  map<int, vector<whisper_token>> prompt_tokens; // per stream
+
+  STTPartialParams partialParams;
+  whisper_full_params partialWparams;
+  whisper_state *partialState = nullptr; // separate from ctx's own state
+  vector<float> partialWindow;           // audio of the current window
+  vector<float> partialNew;              // audio since the last step
+  int partialStream = -1;                // stream the window follows
+  string partialCommitted;               // text of rolled-over windows
+  string partialText;                    // hypothesis of the current window
+  uint64_t partialGeneration = 0;        // bumped when a sentence ends
+  bool stopPartial = false;
+  mutex partialMutex;
+  condition_variable partialCv;
+  thread partialThread;
 };
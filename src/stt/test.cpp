@@ -98,10 +98,15 @@ auto main() -> int {
       readWavFilesFromDirectory(wavDirectory);
 
   spdlog::info("Successfully read {} WAV files.", audioData.size());
+  // events share these buffers instead of copying them
+  std::vector<AudioChunk> chunks;
+  for (auto &audio : audioData) {
+    chunks.emplace_back(std::move(audio));
+  }
 
   // Example: Print info about the first file if available
   if (!audioData.empty()) {
-    spdlog::info("First file has {} samples.", audioData[0].size());
+    spdlog::info("First file has {} samples.", chunks[0].size());
   }
 
   whisper_context_params cparams(whisper_context_default_params());
@@ -129,14 +134,22 @@ auto main() -> int {
   auto eventBus = std::make_shared<EventBus>();
 
   eventBus->subscribe<MessageAddedEvent>(
-      [](const std::shared_ptr<Event> &event) {
-        auto messageEvent = std::static_pointer_cast<MessageAddedEvent>(event);
-        if (messageEvent->serviceName == "stt") {
-          spdlog::info(messageEvent->message);
+      [](const MessageAddedEvent &messageEvent) {
+        if (messageEvent.serviceName == "stt") {
+          spdlog::info(messageEvent.message);
         }
       });
 
-  STT stt(cparams, wparams, model, language, false, eventBus);
+  eventBus->subscribe<MessagePartialEvent>(
+      [](const MessagePartialEvent &partialEvent) {
+        spdlog::info("partial: {}", partialEvent.message);
+      });
+
+  // step 1s, window 5s, keep 200ms
+  STTPartialParams partial{16000, 5 * 16000, 3200};
+  STT stt(cparams, wparams, model, language, false, eventBus, partial);
+  // sentences queued in manual mode are transcribed before they are sent
+  stt.setSpeculative(true);
 
   eventBus->publish<StartServiceEvent>("stt");
   spdlog::info("stt start");
@@ -144,35 +157,50 @@ auto main() -> int {
   // wait thread into lock
   // std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
+  spdlog::info("###########partial test############");
+  // feed the first file as it would be captured, 100ms at a time
+  for (size_t pos = 0; pos < chunks[0].size(); pos += 1600) {
+    eventBus->publish<AudioPartialEvent>(chunks[0].slice(pos, 1600));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
   spdlog::info("###########manual trigger test############");
   eventBus->publish<AutoModeSetEvent>("stt", false);
 
   spdlog::info("stt set auto process 0");
 
-  eventBus->publish<AudioAddedEvent>(audioData[0]);
-  spdlog::info("stt addVoice 0");
+  const uint64_t id0 = next_sentence_id();
+  eventBus->publish<AudioAddedEvent>(chunks[0], 0, id0);
+  spdlog::info("stt addVoice 0, id {}", id0);
+
+  const uint64_t id1 = next_sentence_id();
+  eventBus->publish<AudioAddedEvent>(chunks[1], 0, id1);
+  spdlog::info("stt addVoice 1, id {}", id1);
 
-  eventBus->publish<AudioAddedEvent>(audioData[1]);
-  spdlog::info("stt addVoice 1");
+  // put sentence 1 first, then drop it again
+  eventBus->publish<AudioMovedEvent>(id1, id0);
+  spdlog::info("stt move id {} before id {}", id1, id0);
 
-  eventBus->publish<AudioRemovedEvent>(1);
-  spdlog::info("stt remove index 1");
+  eventBus->publish<AudioRemovedEvent>(id1);
+  spdlog::info("stt remove id {}", id1);
 
+  // sentence 0 is transcribed by now, sending only joins the cached text
+  std::this_thread::sleep_for(std::chrono::seconds(5));
   eventBus->publish<AudioSentEvent>();
   spdlog::info("stt process once");
 
   // std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
   spdlog::info("###########auto trigger test############");
-  eventBus->publish<AudioAddedEvent>(audioData[2]);
+  eventBus->publish<AudioAddedEvent>(chunks[2]);
   spdlog::info("stt addVoice 2");
   // stt.setTriggerMethod(-1);
   // spdlog::info("stt set auto process -1");
 
-  eventBus->publish<AudioAddedEvent>(audioData[2]);
+  eventBus->publish<AudioAddedEvent>(chunks[2]);
   spdlog::info("stt addVoice 2");
 
-  eventBus->publish<AudioAddedEvent>(audioData[3]);
+  eventBus->publish<AudioAddedEvent>(chunks[3]);
   spdlog::info("stt addVoice 3");
 
   // stt.setTriggerMethod(1);
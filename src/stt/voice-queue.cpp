@@ -0,0 +1,70 @@
+#include "voice-queue.h"
+
+auto VoiceQueue::push(Voice voice) -> bool {
+  if (index.contains(voice.id)) {
+    return false;
+  }
+  total += voice.audio.size();
+  voices.push_back(std::move(voice));
+  index.emplace(voices.back().id, prev(voices.end()));
+  return true;
+}
+
+auto VoiceQueue::remove(uint64_t id) -> bool {
+  auto it = index.find(id);
+  if (it == index.end()) {
+    return false;
+  }
+  total -= it->second->audio.size();
+  voices.erase(it->second);
+  index.erase(it);
+  return true;
+}
+
+auto VoiceQueue::move(uint64_t id, uint64_t before_id) -> bool {
+  auto it = index.find(id);
+  if (it == index.end() || id == before_id) {
+    return false;
+  }
+  auto before = voices.end();
+  if (before_id != 0) {
+    auto target = index.find(before_id);
+    if (target == index.end()) {
+      return false;
+    }
+    before = target->second;
+  }
+  // splice keeps every iterator in index valid
+  voices.splice(before, voices, it->second);
+  return true;
+}
+
+void VoiceQueue::clear() {
+  voices.clear();
+  index.clear();
+  total = 0;
+}
+
+auto VoiceQueue::takeAll() -> vector<Voice> {
+  vector<Voice> taken;
+  taken.reserve(voices.size());
+  for (auto &voice : voices) {
+    taken.push_back(std::move(voice));
+  }
+  clear();
+  return taken;
+}
+
+auto VoiceQueue::samplesOf(uint64_t id) const -> size_t {
+  auto it = index.find(id);
+  return it == index.end() ? 0 : it->second->audio.size();
+}
+
+auto VoiceQueue::sizes() const -> vector<size_t> {
+  vector<size_t> result;
+  result.reserve(voices.size());
+  for (const auto &voice : voices) {
+    result.push_back(voice.audio.size());
+  }
+  return result;
+}
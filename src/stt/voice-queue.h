@@ -0,0 +1,47 @@
+#pragma once
+#include "audiochunk.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Sentences waiting for transcription, addressed by sentence ID. Removing,
+// moving and looking up a sentence are O(1) and never copy audio. Not
+// thread-safe; STT guards it with queueMutex.
+class VoiceQueue {
+public:
+  struct Voice {
+    uint64_t id;
+    AudioChunk audio; // shared with the AudioAddedEvent, not copied
+    int stream_id;
+    AudioChunk::Clock::time_point queued{}; // traced as the queue wait
+  };
+
+  // Returns false if the ID is already queued.
+  auto push(Voice voice) -> bool;
+  auto remove(uint64_t id) -> bool;
+  // Moves id in front of before_id, or to the back if before_id is 0.
+  auto move(uint64_t id, uint64_t before_id) -> bool;
+  void clear();
+
+  // Takes every queued sentence, oldest first.
+  auto takeAll() -> vector<Voice>;
+
+  [[nodiscard]] auto contains(uint64_t id) const -> bool {
+    return index.contains(id);
+  }
+  // Samples of one sentence, 0 if it is not queued.
+  [[nodiscard]] auto samplesOf(uint64_t id) const -> size_t;
+  // Samples of every sentence, in queue order.
+  [[nodiscard]] auto sizes() const -> vector<size_t>;
+  [[nodiscard]] auto size() const -> size_t { return voices.size(); }
+  [[nodiscard]] auto empty() const -> bool { return voices.empty(); }
+  [[nodiscard]] auto totalSamples() const -> size_t { return total; }
+
+private:
+  list<Voice> voices;
+  unordered_map<uint64_t, list<Voice>::iterator> index;
+  size_t total = 0;
+};
@@ -0,0 +1,131 @@
+#include "whisper-pool.h"
+
+#include <spdlog/spdlog.h>
+#include <utility>
+
+WhisperPool::WhisperPool(whisper_context *ctx, int n_workers,
+                         Transcribe transcribe, Deliver deliver)
+    : transcribe(std::move(transcribe)), deliver(std::move(deliver)) {
+  // Each state holds its own KV cache and compute buffers; the weights stay
+  // in ctx and are shared.
+  for (int i = 0; i < max(n_workers, 1); ++i) {
+    whisper_state *state = whisper_init_state(ctx);
+    if (state == nullptr) {
+      spdlog::error("WhisperPool: failed to create state {}", i);
+      break;
+    }
+    states.push_back(state);
+  }
+  spdlog::info("WhisperPool: {} workers", states.size());
+}
+
+WhisperPool::~WhisperPool() {
+  stop();
+  for (auto *state : states) {
+    whisper_free_state(state);
+  }
+}
+
+void WhisperPool::start() {
+  {
+    lock_guard<mutex> lock(jobMutex);
+    stopping = false;
+  }
+  for (auto *state : states) {
+    workers.emplace_back(&WhisperPool::work, this, state);
+  }
+}
+
+void WhisperPool::stop() {
+  {
+    lock_guard<mutex> lock(jobMutex);
+    stopping = true;
+    queue<Job> empty;
+    swap(jobs, empty);
+  }
+  jobCv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+
+  // Dropped jobs leave gaps, so restart numbering from scratch.
+  lock_guard<mutex> jobLock(jobMutex);
+  lock_guard<mutex> resultLock(resultMutex);
+  results.clear();
+  nextSeq = nextDeliver = 0;
+}
+
+void WhisperPool::submit(AudioChunk audio, int stream_id, uint64_t trace_id) {
+  submit(std::move(audio), stream_id, trace_id, nullptr);
+}
+
+void WhisperPool::submit(AudioChunk audio, int stream_id, uint64_t trace_id,
+                         Deliver on_done) {
+  const Trace trace{trace_id, audio.captured_at()};
+  {
+    lock_guard<mutex> lock(jobMutex);
+    jobs.push({nextSeq++, stream_id, std::move(audio), std::move(on_done),
+               trace, Tracer::Clock::now()});
+    jobsMetric.set(static_cast<double>(jobs.size()));
+  }
+  jobCv.notify_one();
+}
+
+void WhisperPool::work(whisper_state *state) {
+  while (true) {
+    Job job;
+    {
+      unique_lock<mutex> lock(jobMutex);
+      jobCv.wait(lock, [this]() { return !jobs.empty() || stopping; });
+      if (stopping) {
+        return;
+      }
+      job = std::move(jobs.front());
+      jobs.pop();
+      jobsMetric.set(static_cast<double>(jobs.size()));
+    }
+
+    auto &tracer = Tracer::instance();
+    const auto start = Tracer::Clock::now();
+    tracer.record("stt.wait", job.trace.id, job.submitted, start,
+                  job.stream_id);
+    string text = transcribe(state, job.audio.samples(), job.stream_id);
+    tracer.record("stt.whisper", job.trace, start, job.stream_id);
+
+    const chrono::duration<double> elapsed = Tracer::Clock::now() - start;
+    whisperMetric.record(elapsed);
+    if (job.audio.duration().count() > 0) {
+      rtfMetric.set(elapsed / job.audio.duration());
+    }
+
+    complete(job.seq, {std::move(text), job.stream_id, std::move(job.on_done),
+                       job.trace});
+  }
+}
+
+// Submitted minus delivered jobs.
+auto WhisperPool::pending() -> uint64_t {
+  // delivered first: it never passes the submitted count read after it
+  uint64_t delivered = 0;
+  {
+    lock_guard<mutex> lock(resultMutex);
+    delivered = nextDeliver;
+  }
+  lock_guard<mutex> lock(jobMutex);
+  return nextSeq - delivered;
+}
+
+// Delivers this result and any later ones that were waiting on it. Holding
+// resultMutex while delivering keeps deliveries serialized and in order.
+void WhisperPool::complete(uint64_t seq, Result result) {
+  lock_guard<mutex> lock(resultMutex);
+  results.emplace(seq, std::move(result));
+  for (auto it = results.find(nextDeliver); it != results.end();
+       it = results.find(nextDeliver)) {
+    auto &[text, stream_id, on_done, trace] = it->second;
+    (on_done ? on_done : deliver)(std::move(text), stream_id, trace);
+    results.erase(it);
+    ++nextDeliver;
+  }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "audiochunk.h"
+#include "metrics.h"
+#include "trace.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <whisper.h>
+
+using namespace std;
+
+// Runs transcriptions on N whisper_state instances that share one loaded
+// whisper_context. Jobs are taken in submission order by whichever worker
+// is free, and results are delivered in submission order.
+class WhisperPool {
+public:
+  // Transcribes pcmf32 of the given stream on the given state. Called
+  // concurrently from different workers, each with its own state.
+  using Transcribe = function<string(
+      whisper_state *state, span<const float> pcmf32, int stream_id)>;
+  // Receives results one at a time, in submission order.
+  using Deliver = function<void(string text, int stream_id, Trace trace)>;
+
+  WhisperPool(whisper_context *ctx, int n_workers, Transcribe transcribe,
+              Deliver deliver);
+  ~WhisperPool();
+
+  WhisperPool(const WhisperPool &) = delete;
+  auto operator=(const WhisperPool &) -> WhisperPool & = delete;
+
+  void start();
+  // Finishes the jobs in flight and drops the queued ones.
+  void stop();
+
+  // The chunk is shared, not copied, until the job is transcribed. The time
+  // waiting for a worker and in whisper is traced under trace_id.
+  void submit(AudioChunk audio, int stream_id = 0, uint64_t trace_id = 0);
+  // Same, but the result goes to on_done instead of the pool's Deliver. It
+  // is still delivered in submission order, on the delivering worker.
+  void submit(AudioChunk audio, int stream_id, uint64_t trace_id,
+              Deliver on_done);
+
+  [[nodiscard]] auto size() const -> int {
+    return static_cast<int>(states.size());
+  }
+  // Jobs submitted and not delivered yet.
+  [[nodiscard]] auto pending() -> uint64_t;
+
+private:
+  struct Job {
+    uint64_t seq;
+    int stream_id;
+    AudioChunk audio;
+    Deliver on_done; // empty: the pool's Deliver
+    Trace trace;
+    Tracer::Clock::time_point submitted;
+  };
+
+  struct Result {
+    string text;
+    int stream_id;
+    Deliver on_done;
+    Trace trace;
+  };
+
+  void work(whisper_state *state);
+  void complete(uint64_t seq, Result result);
+
+  vector<whisper_state *> states;
+  vector<thread> workers;
+  Transcribe transcribe;
+  Deliver deliver;
+
+  mutex jobMutex;
+  condition_variable jobCv;
+  queue<Job> jobs;
+  uint64_t nextSeq = 0;
+  bool stopping = false;
+
+  // Results that finished ahead of an earlier job wait here.
+  mutex resultMutex;
+  map<uint64_t, Result> results;
+  uint64_t nextDeliver = 0;
+
+  // Jobs waiting for a worker, transcription time and real-time factor
+  // (transcription time / audio duration) of the last job.
+  Gauge &jobsMetric = Metrics::instance().gauge("stt.jobs");
+  Histogram &whisperMetric = Metrics::instance().histogram("stt.whisper");
+  Gauge &rtfMetric = Metrics::instance().gauge("stt.rtf");
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// 固定容量的采样环，满了覆盖最早的采样，内存与运行时长无关。
+// 采样按时间顺序追加。绘制时按像素列抽取，每列只保留最小值和最大值，
+// 交给图表的点数只与宽度有关。只在GUI线程中使用，不加锁。
+class TimeSeries {
+public:
+  struct Sample {
+    double t;
+    double value;
+  };
+
+  explicit TimeSeries(size_t capacity)
+      : samples(std::max<size_t>(capacity, 1)) {}
+
+  void append(double t, double value) {
+    samples[(first + n) % samples.size()] = {t, value};
+    if (n < samples.size()) {
+      n++;
+    } else {
+      first = (first + 1) % samples.size();
+    }
+  }
+
+  [[nodiscard]] auto size() const -> size_t { return n; }
+  [[nodiscard]] auto capacity() const -> size_t { return samples.size(); }
+  // 从早到晚第i个采样
+  [[nodiscard]] auto at(size_t i) const -> const Sample & {
+    return samples[(first + i) % samples.size()];
+  }
+
+  // 把[begin, end]分成columns列，按时间顺序对每列的最小值和最大值调用
+  // out(t, value)，各列只有一个采样时只调用一次。begin之前的最后一个采样
+  // 也输出，曲线从左边缘开始。
+  template <typename Out>
+  void decimate(double begin, double end, int columns, Out &&out) const {
+    if (n == 0 || end <= begin || columns <= 0) {
+      return;
+    }
+    // 第一个不早于begin的采样
+    size_t lo = 0;
+    size_t hi = n;
+    while (lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      if (at(mid).t < begin) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo > 0) {
+      out(at(lo - 1).t, at(lo - 1).value);
+    }
+
+    const double width = (end - begin) / columns;
+    size_t i = lo;
+    while (i < n && at(i).t <= end) {
+      const auto column = static_cast<long>((at(i).t - begin) / width);
+      const Sample *min = &at(i);
+      const Sample *max = min;
+      for (++i; i < n && at(i).t <= end &&
+                static_cast<long>((at(i).t - begin) / width) == column;
+           ++i) {
+        const Sample &sample = at(i);
+        if (sample.value < min->value) {
+          min = &sample;
+        }
+        if (sample.value > max->value) {
+          max = &sample;
+        }
+      }
+      const Sample *a = min->t <= max->t ? min : max;
+      const Sample *b = a == min ? max : min;
+      out(a->t, a->value);
+      if (b != a) {
+        out(b->t, b->value);
+      }
+    }
+  }
+
+private:
+  std::vector<Sample> samples;
+  size_t first = 0; // 最早的采样
+  size_t n = 0;
+};
@@ -27,31 +27,38 @@ CardMan::CardMan(QWidget *parent) : QWidget(parent) {
 
 void CardMan::setEventBus(std::shared_ptr<EventBus> bus) {
   eventBus = std::move(bus);
+  // 事件可能来自采集线程或识别线程，卡片只能在GUI线程中修改
+  executor = std::make_shared<QtExecutor>(this, 1024, Overflow::Block);
 
   eventBus->subscribe<AudioAddedEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto audioEvent = std::static_pointer_cast<AudioAddedEvent>(event);
-        addCard(QString::number(audioEvent->audio.size() / 16000.0, 'f', 1) +
-                "S");
-      });
+      [this](const AudioAddedEvent &audioEvent) {
+        addCard(audioEvent.id,
+                QString::number(audioEvent.audio.duration().count(), 'f', 1) +
+                    "S");
+      },
+      executor);
 
   eventBus->subscribe<AudioRemovedEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto audioEvent = std::static_pointer_cast<AudioRemovedEvent>(event);
-        removeCard(audioEvent->index);
-      });
+      [this](const AudioRemovedEvent &audioEvent) {
+        removeCard(audioEvent.id);
+      },
+      executor);
+
+  eventBus->subscribe<AudioMovedEvent>(
+      [this](const AudioMovedEvent &audioEvent) {
+        moveCard(audioEvent.id, audioEvent.before_id);
+      },
+      executor);
 
   eventBus->subscribe<AudioClearedEvent>(
-      [this](const std::shared_ptr<Event> &event) { clearCards(); });
+      [this](const AudioClearedEvent &) { clearCards(); }, executor);
 
   eventBus->subscribe<ServiceStatusEvent>(
-      [this](const std::shared_ptr<Event> &event) {
-        auto serviceEvent = std::static_pointer_cast<ServiceStatusEvent>(event);
-
+      [this](const ServiceStatusEvent &serviceEvent) {
         spdlog::info("receive service status event {}",
-                     serviceEvent->serviceName);
-        if (serviceEvent->serviceName == "sentense") {
-          if (serviceEvent->isRunning) {
+                     serviceEvent.serviceName);
+        if (serviceEvent.serviceName == "sentense") {
+          if (serviceEvent.isRunning) {
             isRecording = true;
             recordButton.setChecked(true);
             spdlog::info("set to true.");
@@ -61,7 +68,8 @@ void CardMan::setEventBus(std::shared_ptr<EventBus> bus) {
             spdlog::info("set to false.");
           }
         }
-      });
+      },
+      executor);
 
   eventBus->publish<AutoModeSetEvent>("stt", false);
 }
@@ -129,7 +137,8 @@ void CardMan::setupControlButtons() {
 
 CardMan::~CardMan() = default;
 
-void CardMan::createCard(const QString &text) {
+// 卡片的事件处理函数由QtExecutor在GUI线程中调用，可以直接修改卡片
+void CardMan::addCard(uint64_t id, const QString &text) {
   auto *card = new QFrame(cardsContainer);
   card->setFixedWidth(120);
   card->setMinimumHeight(20);
@@ -158,47 +167,52 @@ void CardMan::createCard(const QString &text) {
       "QPushButton { border: none; font-size: 16px; color: #999; }"
       "QPushButton:hover { color: #f00; }");
   closeButton->setFixedSize(20, 20);
-  connect(closeButton, &QPushButton::clicked, [this, card]() {
-    auto it = std::ranges::find(cardFrames, card);
-    if (it != cardFrames.end()) {
-      int index = std::distance(cardFrames.begin(), it);
-      eventBus->publish<AudioRemovedEvent>(index);
-    }
-  });
+  connect(closeButton, &QPushButton::clicked,
+          [this, id]() { eventBus->publish<AudioRemovedEvent>(id); });
   cardLayout->addWidget(closeButton);
 
   cardsLayout->addWidget(card);
-  cardFrames.push_back(card);
+  cards.push_back({id, card});
 }
 
-void CardMan::clearAllCards() {
-  for (auto card : cardFrames) {
-    cardsLayout->removeWidget(card);
-    delete card;
-  }
-  cardFrames.clear();
+auto CardMan::findCard(uint64_t id) -> std::vector<Card>::iterator {
+  return std::ranges::find(cards, id, &Card::id);
 }
 
-void CardMan::addCard(const QString &text) {
-  QMetaObject::invokeMethod(
-      this, [this, text]() { createCard(text); }, Qt::QueuedConnection);
+void CardMan::removeCard(uint64_t id) {
+  auto it = findCard(id);
+  if (it == cards.end()) {
+    return;
+  }
+  cardsLayout->removeWidget(it->frame);
+  // 可能正在处理该卡片关闭按钮的点击信号，延迟删除
+  it->frame->deleteLater();
+  cards.erase(it);
 }
 
-void CardMan::removeCard(int index) {
-  QMetaObject::invokeMethod(
-      this,
-      [this, index]() {
-        if (index >= 0 && index < static_cast<int>(cardFrames.size())) {
-          QFrame *card = cardFrames[index];
-          cardsLayout->removeWidget(card);
-          delete card;
-          cardFrames.erase(cardFrames.begin() + index);
-        }
-      },
-      Qt::QueuedConnection);
+void CardMan::moveCard(uint64_t id, uint64_t before_id) {
+  auto it = findCard(id);
+  if (it == cards.end() || id == before_id ||
+      (before_id != 0 && findCard(before_id) == cards.end())) {
+    return;
+  }
+  Card card = *it;
+  cards.erase(it);
+  cards.insert(before_id == 0 ? cards.end() : findCard(before_id), card);
+
+  // FlowLayout只能追加，按新顺序重新加入所有卡片
+  for (const auto &c : cards) {
+    cardsLayout->removeWidget(c.frame);
+  }
+  for (const auto &c : cards) {
+    cardsLayout->addWidget(c.frame);
+  }
 }
 
 void CardMan::clearCards() {
-  QMetaObject::invokeMethod(
-      this, [this]() { clearAllCards(); }, Qt::QueuedConnection);
+  for (const auto &card : cards) {
+    cardsLayout->removeWidget(card.frame);
+    card.frame->deleteLater();
+  }
+  cards.clear();
 }
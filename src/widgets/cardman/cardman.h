@@ -3,11 +3,13 @@
 
 #include "eventbus.h"
 #include "flowlayout.h"
+#include "qtexecutor.h"
 #include <QCheckBox>
 #include <QFrame>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QWidget>
+#include <cstdint>
 #include <qpushbutton.h>
 
 class CardMan : public QWidget {
@@ -19,12 +21,14 @@ public:
   void setEventBus(std::shared_ptr<EventBus> bus);
 
 private slots:
-  void addCard(const QString &text);
-  void removeCard(int index);
+  void addCard(uint64_t id, const QString &text);
+  void removeCard(uint64_t id);
+  void moveCard(uint64_t id, uint64_t before_id);
   void clearCards();
 
 private:
   std::shared_ptr<EventBus> eventBus;
+  std::shared_ptr<QtExecutor> executor; // 事件处理在GUI线程中执行
 
   QScrollArea *scrollArea;
   QWidget *cardsContainer;
@@ -32,10 +36,13 @@ private:
   QPushButton sendButton;
   QPushButton clearButton;
   QCheckBox *autoTriggerCheckBox;
-  std::vector<QFrame *> cardFrames;
+  struct Card {
+    uint64_t id; // 句子编号，见AudioAddedEvent::id
+    QFrame *frame;
+  };
+  std::vector<Card> cards;
 
-  void createCard(const QString &text);
-  void clearAllCards();
+  auto findCard(uint64_t id) -> std::vector<Card>::iterator;
   void setupControlButtons();
 
   bool isRecording = false;
@@ -6,6 +6,7 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QWidget>
+#include <deque>
 
 auto main(int argc, char *argv[]) -> int {
   QApplication app(argc, argv);
@@ -18,17 +19,15 @@ auto main(int argc, char *argv[]) -> int {
   auto eventBus = std::make_shared<EventBus>();
 
   eventBus->subscribe<StartServiceEvent>(
-      [eventBus](const std::shared_ptr<Event> &event) {
-        auto startEvent = std::static_pointer_cast<StartServiceEvent>(event);
-        if (startEvent->serviceName == "sentense") {
+      [eventBus](const StartServiceEvent &startEvent) {
+        if (startEvent.serviceName == "sentense") {
           eventBus->publish<ServiceStatusEvent>("sentense", true);
         }
       });
 
   eventBus->subscribe<StopServiceEvent>(
-      [eventBus](const std::shared_ptr<Event> &event) {
-        auto stopEvent = std::static_pointer_cast<StopServiceEvent>(event);
-        if (stopEvent->serviceName == "sentense") {
+      [eventBus](const StopServiceEvent &stopEvent) {
+        if (stopEvent.serviceName == "sentense") {
           eventBus->publish<ServiceStatusEvent>("sentense", false);
         }
       });
@@ -54,19 +53,30 @@ auto main(int argc, char *argv[]) -> int {
   mainLayout->addWidget(controlPanel);
 
   // 连接按钮信号
+  // 按添加顺序记录句子编号，删除时删除最早的一个
+  std::deque<uint64_t> ids;
+
   QObject::connect(addButton, &QPushButton::clicked, [&]() {
     QString text = inputLine->text().trimmed();
     if (!text.isEmpty()) {
-      eventBus->publish<AudioAddedEvent>(std::vector<float>{text.toFloat()});
+      ids.push_back(next_sentence_id());
+      eventBus->publish<AudioAddedEvent>(
+          AudioChunk(std::vector<float>{text.toFloat()}), 0, ids.back());
       inputLine->clear();
     }
   });
 
-  QObject::connect(removeButton, &QPushButton::clicked,
-                   [&]() { eventBus->publish<AudioRemovedEvent>(0); });
+  QObject::connect(removeButton, &QPushButton::clicked, [&]() {
+    if (!ids.empty()) {
+      eventBus->publish<AudioRemovedEvent>(ids.front());
+      ids.pop_front();
+    }
+  });
 
-  QObject::connect(clearButton, &QPushButton::clicked,
-                   [&]() { eventBus->publish<AudioClearedEvent>(); });
+  QObject::connect(clearButton, &QPushButton::clicked, [&]() {
+    ids.clear();
+    eventBus->publish<AudioClearedEvent>();
+  });
 
   mainWindow.show();
   return app.exec();